@@ -0,0 +1,394 @@
+﻿// Пакетная оценка позиций: массив позиций — массив оценок.
+// Оценка та же, что у Logic::calc_score: материал (шашки и дамки), продвижение шашек к превращению
+// и позиционные слагаемые (центр, первый ряд, подвижность), с точки зрения стороны, чья очередь хода. Считается прямо по маскам позиции, так что подходят
+// и позиции, прочитанные из файлов. На x86 по 8 позиций за инструкцию (AVX2) или по 4 (SSE2),
+// набор инструкций выбирается при запуске по возможностям процессора; на других платформах — по одной
+#pragma once
+#include <stdint.h>
+
+#include "../Models/Position.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define CHECKERS_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#endif
+
+#if defined(CHECKERS_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define CHECKERS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+    #define CHECKERS_TARGET_AVX2
+#endif
+
+const int WIN_SCORE = 1000000; // Оценка выигрыша (в поиске уменьшается с каждым полуходом до него)
+
+// Веса слагаемых оценки в сотых долях шашки. Позиционные слагаемые по умолчанию выключены,
+// их веса подбирает Tools/texel.cpp и читает Logic из файла Bot.WeightsPath
+struct EvalWeights
+{
+    int man = 100;     // Шашка
+    int king = 400;    // Дамка
+    int advance = 0;   // Каждый ряд, пройденный шашкой к превращению
+    int center = 0;    // Фигура на одной из 8 центральных клеток
+    int back_rank = 0; // Шашка на своём первом ряду — закрывает соперникам путь в дамки
+    int mobility = 0;  // Каждый шаг фигуры на соседнюю пустую клетку (шашки — только вперёд)
+
+    static const int COUNT = 6;
+    // Наибольший модуль веса: оценка остаётся далеко от WIN_BOUND, а вес помещается в int16 (SSE2)
+    static const int MAX_WEIGHT = 4096;
+
+    // Веса по номеру — для файла весов и их настройки; порядок тот же, что у BatchEval::features
+    int& operator[](const int i)
+    {
+        return this->*fields()[i];
+    }
+
+    int operator[](const int i) const
+    {
+        return this->*fields()[i];
+    }
+
+    static const char* name(const int i)
+    {
+        static const char* const names[COUNT] = { "man", "king", "advance", "center", "back_rank", "mobility" };
+        return names[i];
+    }
+
+    // Нужны ли слагаемые, которых нет в EvalTerms позиции (их считает BatchEval::positional)
+    bool has_positional() const
+    {
+        return center || back_rank || mobility;
+    }
+
+private:
+    static int EvalWeights::* const* fields()
+    {
+        static int EvalWeights::* const res[COUNT] = { &EvalWeights::man,    &EvalWeights::king,
+                                                       &EvalWeights::advance, &EvalWeights::center,
+                                                       &EvalWeights::back_rank, &EvalWeights::mobility };
+        return res;
+    }
+};
+
+// Маски клеток, у которых установлен бит 0, 1, 2 номера ряда (ряд клетки sq — sq / 4)
+const uint32_t ROW_BIT0 = 0xF0F0F0F0u;
+const uint32_t ROW_BIT1 = 0xFF00FF00u;
+const uint32_t ROW_BIT2 = 0xFFFF0000u;
+
+// Позиционные маски: центр (ряды 2..5, столбцы 2..5), первый ряд белых (7) и чёрных (0)
+const uint32_t CENTER_MASK = 0x00666600u;
+const uint32_t BACK_RANK_WHITE = 0xF0000000u;
+const uint32_t BACK_RANK_BLACK = 0x0000000Fu;
+// Для шагов по диагонали: клетка sq соседствует с sq ± 4 и в чётном ряду с sq - 3 / sq + 5 (кроме
+// последней клетки ряда), в нечётном — с sq - 5 / sq + 3 (кроме первой клетки ряда)
+const uint32_t EVEN_ROWS = 0x0F0F0F0Fu;
+const uint32_t ODD_ROWS = 0xF0F0F0F0u;
+const uint32_t NOT_ROW_END = 0x77777777u;
+const uint32_t NOT_ROW_START = 0xEEEEEEEEu;
+
+class BatchEval
+{
+public:
+    enum class Isa
+    {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    // Лучший набор инструкций, доступный на этом процессоре
+    static Isa detect()
+    {
+#ifdef CHECKERS_X86
+    #ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 7)
+        {
+            __cpuid(info, 1);
+            const bool os_avx = (info[2] >> 27 & 1) && (_xgetbv(0) & 6) == 6; // OSXSAVE и регистры YMM
+            __cpuidex(info, 7, 0);
+            if (os_avx && (info[1] >> 5 & 1))
+                return Isa::AVX2;
+        }
+        return Isa::SSE2;
+    #else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return Isa::AVX2;
+        return __builtin_cpu_supports("sse2") ? Isa::SSE2 : Isa::SCALAR;
+    #endif
+#else
+        return Isa::SCALAR;
+#endif
+    }
+
+    static const char* isa_name(const Isa isa)
+    {
+        return isa == Isa::AVX2 ? "AVX2" : isa == Isa::SSE2 ? "SSE2" : "scalar";
+    }
+
+    // Оценка count позиций подряд в scores; isa задаёт набор инструкций (по умолчанию — лучший доступный)
+    static void evaluate(const Position* positions, const int count, const EvalWeights& weights, int* scores,
+                         const Isa isa = best_isa())
+    {
+        int i = 0;
+#ifdef CHECKERS_X86
+        if (isa == Isa::AVX2)
+            i = evaluate_avx2(positions, count, weights, scores);
+        else if (isa == Isa::SSE2)
+            i = evaluate_sse2(positions, count, weights, scores);
+#endif
+        for (; i < count; ++i)
+            scores[i] = evaluate(positions[i], weights);
+    }
+
+    // Оценка одной позиции (совпадает с пакетной)
+    static int evaluate(const Position& pos, const EvalWeights& weights)
+    {
+        const uint32_t own = pos.pieces(pos.color), enemy = pos.pieces(!pos.color);
+        if (!own)
+            return -WIN_SCORE;
+        if (!enemy)
+            return WIN_SCORE;
+        const uint32_t wm = pos.white & ~pos.kings, bm = pos.black & ~pos.kings;
+        const int w = weights.man * popcount(wm) + weights.king * popcount(pos.white & pos.kings) +
+                      weights.advance * (7 * popcount(wm) - row_sum(wm));
+        const int b = weights.man * popcount(bm) + weights.king * popcount(pos.black & pos.kings) +
+                      weights.advance * row_sum(bm);
+        const int diff = w - b + (weights.has_positional() ? positional(pos, weights) : 0);
+        return pos.color ? -diff : diff;
+    }
+
+    // Позиционные слагаемые (центр, первый ряд, подвижность) с точки зрения белых
+    static int positional(const Position& pos, const EvalWeights& weights)
+    {
+        const uint32_t empty = ~pos.occupied();
+        const uint32_t wk = pos.white & pos.kings, bk = pos.black & pos.kings;
+        return weights.center * (popcount(pos.white & CENTER_MASK) - popcount(pos.black & CENTER_MASK)) +
+               weights.back_rank * (popcount(pos.white & ~pos.kings & BACK_RANK_WHITE) -
+                                    popcount(pos.black & ~pos.kings & BACK_RANK_BLACK)) +
+               weights.mobility * (steps_up(pos.white, empty) + steps_down(wk, empty) -
+                                   steps_down(pos.black, empty) - steps_up(bk, empty));
+    }
+
+    // Слагаемые оценки с точки зрения белых (разность белых и чёрных) в порядке весов EvalWeights:
+    // оценка позиции без выигрыша — их сумма с весами. По ним подбирает веса Tools/texel.cpp
+    static void features(const Position& pos, int* res)
+    {
+        const uint32_t wm = pos.white & ~pos.kings, bm = pos.black & ~pos.kings;
+        const uint32_t wk = pos.white & pos.kings, bk = pos.black & pos.kings;
+        const uint32_t empty = ~pos.occupied();
+        res[0] = popcount(wm) - popcount(bm);
+        res[1] = popcount(wk) - popcount(bk);
+        res[2] = 7 * popcount(wm) - row_sum(wm) - row_sum(bm);
+        res[3] = popcount(pos.white & CENTER_MASK) - popcount(pos.black & CENTER_MASK);
+        res[4] = popcount(wm & BACK_RANK_WHITE) - popcount(bm & BACK_RANK_BLACK);
+        res[5] = steps_up(pos.white, empty) + steps_down(wk, empty) - steps_down(pos.black, empty) - steps_up(bk, empty);
+    }
+
+    static Isa best_isa()
+    {
+        static const Isa isa = detect();
+        return isa;
+    }
+
+private:
+    // Сумма номеров рядов фигур маски: по битам номера ряда
+    static int row_sum(const uint32_t mask)
+    {
+        return popcount(mask & ROW_BIT0) + 2 * popcount(mask & ROW_BIT1) + 4 * popcount(mask & ROW_BIT2);
+    }
+
+    // Число шагов фигур маски на соседние пустые клетки к ряду 0 (вперёд для белых) и к ряду 7
+    static int steps_up(const uint32_t pieces, const uint32_t empty)
+    {
+        return popcount(pieces >> 4 & empty) + popcount((pieces & EVEN_ROWS & NOT_ROW_END) >> 3 & empty) +
+               popcount((pieces & ODD_ROWS & NOT_ROW_START) >> 5 & empty);
+    }
+
+    static int steps_down(const uint32_t pieces, const uint32_t empty)
+    {
+        return popcount(pieces << 4 & empty) + popcount((pieces & EVEN_ROWS & NOT_ROW_END) << 5 & empty) +
+               popcount((pieces & ODD_ROWS & NOT_ROW_START) << 3 & empty);
+    }
+
+#ifdef CHECKERS_X86
+    // Число установленных битов в каждом 32-битном элементе (параллельное сложение по группам битов)
+    static inline __m128i popcount_sse2(__m128i x)
+    {
+        x = _mm_sub_epi32(x, _mm_and_si128(_mm_srli_epi32(x, 1), _mm_set1_epi32(0x55555555)));
+        x = _mm_add_epi32(_mm_and_si128(x, _mm_set1_epi32(0x33333333)),
+                          _mm_and_si128(_mm_srli_epi32(x, 2), _mm_set1_epi32(0x33333333)));
+        x = _mm_and_si128(_mm_add_epi32(x, _mm_srli_epi32(x, 4)), _mm_set1_epi32(0x0F0F0F0F));
+        x = _mm_add_epi32(x, _mm_srli_epi32(x, 8));
+        x = _mm_add_epi32(x, _mm_srli_epi32(x, 16));
+        return _mm_and_si128(x, _mm_set1_epi32(0x3F));
+    }
+
+    // Умножение неотрицательных 32-битных элементов меньше 2^15 на вес, помещающийся в int16
+    // (модуль весов ограничен EvalWeights::MAX_WEIGHT)
+    // (в SSE2 нет 32-битного умножения, поэтому используется умножение 16-битных половин)
+    static inline __m128i mul_small_sse2(const __m128i x, const int weight)
+    {
+        return _mm_madd_epi16(x, _mm_set1_epi32(weight & 0xFFFF));
+    }
+
+    // Шаги фигур на соседние пустые клетки к ряду 0 (up) или к ряду 7
+    static inline __m128i steps_sse2(const __m128i pieces, const __m128i empty, const bool up)
+    {
+        const __m128i even = _mm_and_si128(pieces, _mm_set1_epi32(int(EVEN_ROWS & NOT_ROW_END)));
+        const __m128i odd = _mm_and_si128(pieces, _mm_set1_epi32(int(ODD_ROWS & NOT_ROW_START)));
+        const __m128i a = up ? _mm_srli_epi32(pieces, 4) : _mm_slli_epi32(pieces, 4);
+        const __m128i b = up ? _mm_srli_epi32(even, 3) : _mm_slli_epi32(even, 5);
+        const __m128i c = up ? _mm_srli_epi32(odd, 5) : _mm_slli_epi32(odd, 3);
+        return _mm_add_epi32(_mm_add_epi32(popcount_sse2(_mm_and_si128(a, empty)), popcount_sse2(_mm_and_si128(b, empty))),
+                             popcount_sse2(_mm_and_si128(c, empty)));
+    }
+
+    // Материал и продвижение одной стороны: side = 0 — белые (продвижение 7 - ряд), 1 — чёрные,
+    // и позиционные слагаемые, если их веса не нулевые
+    static inline __m128i side_score_sse2(const __m128i pieces, const __m128i kings, const __m128i empty,
+                                          const bool side, const EvalWeights& w)
+    {
+        const __m128i men = _mm_andnot_si128(kings, pieces);
+        const __m128i n_men = popcount_sse2(men);
+        const __m128i n_kings = popcount_sse2(_mm_and_si128(pieces, kings));
+        __m128i rows = popcount_sse2(_mm_and_si128(men, _mm_set1_epi32(int(ROW_BIT0))));
+        rows = _mm_add_epi32(rows, _mm_slli_epi32(popcount_sse2(_mm_and_si128(men, _mm_set1_epi32(int(ROW_BIT1)))), 1));
+        rows = _mm_add_epi32(rows, _mm_slli_epi32(popcount_sse2(_mm_and_si128(men, _mm_set1_epi32(int(ROW_BIT2)))), 2));
+        const __m128i advance = side ? rows : _mm_sub_epi32(mul_small_sse2(n_men, 7), rows);
+        __m128i res = _mm_add_epi32(_mm_add_epi32(mul_small_sse2(n_men, w.man), mul_small_sse2(n_kings, w.king)),
+                                    mul_small_sse2(advance, w.advance));
+        if (!w.has_positional())
+            return res;
+        const __m128i center = popcount_sse2(_mm_and_si128(pieces, _mm_set1_epi32(int(CENTER_MASK))));
+        const __m128i back =
+            popcount_sse2(_mm_and_si128(men, _mm_set1_epi32(int(side ? BACK_RANK_BLACK : BACK_RANK_WHITE))));
+        const __m128i own_kings = _mm_and_si128(pieces, kings);
+        const __m128i steps = _mm_add_epi32(steps_sse2(side ? own_kings : pieces, empty, true),
+                                            steps_sse2(side ? pieces : own_kings, empty, false));
+        res = _mm_add_epi32(res, _mm_add_epi32(mul_small_sse2(center, w.center), mul_small_sse2(back, w.back_rank)));
+        return _mm_add_epi32(res, mul_small_sse2(steps, w.mobility));
+    }
+
+    // Возвращает число оценённых позиций (кратное 4), остаток досчитывается по одной
+    static int evaluate_sse2(const Position* p, const int count, const EvalWeights& w, int* scores)
+    {
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i white = _mm_set_epi32(int(p[i + 3].white), int(p[i + 2].white), int(p[i + 1].white),
+                                                int(p[i].white));
+            const __m128i black = _mm_set_epi32(int(p[i + 3].black), int(p[i + 2].black), int(p[i + 1].black),
+                                                int(p[i].black));
+            const __m128i kings = _mm_set_epi32(int(p[i + 3].kings), int(p[i + 2].kings), int(p[i + 1].kings),
+                                                int(p[i].kings));
+            const __m128i black_turn = _mm_set_epi32(-int(p[i + 3].color), -int(p[i + 2].color),
+                                                     -int(p[i + 1].color), -int(p[i].color));
+
+            const __m128i empty = _mm_xor_si128(_mm_or_si128(white, black), _mm_set1_epi32(-1));
+            const __m128i diff = _mm_sub_epi32(side_score_sse2(white, kings, empty, 0, w),
+                                               side_score_sse2(black, kings, empty, 1, w));
+            __m128i res = _mm_sub_epi32(_mm_xor_si128(diff, black_turn), black_turn); // Смена знака при ходе чёрных
+
+            // Сторона без фигур: проигрыш, если это сторона, чья очередь, иначе выигрыш
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i own = _mm_or_si128(_mm_and_si128(black_turn, black), _mm_andnot_si128(black_turn, white));
+            const __m128i enemy = _mm_or_si128(_mm_and_si128(black_turn, white), _mm_andnot_si128(black_turn, black));
+            const __m128i no_enemy = _mm_cmpeq_epi32(enemy, zero), no_own = _mm_cmpeq_epi32(own, zero);
+            res = _mm_or_si128(_mm_andnot_si128(no_enemy, res), _mm_and_si128(no_enemy, _mm_set1_epi32(WIN_SCORE)));
+            res = _mm_or_si128(_mm_andnot_si128(no_own, res), _mm_and_si128(no_own, _mm_set1_epi32(-WIN_SCORE)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(scores + i), res);
+        }
+        return i;
+    }
+
+    CHECKERS_TARGET_AVX2 static inline __m256i popcount_avx2(__m256i x)
+    {
+        x = _mm256_sub_epi32(x, _mm256_and_si256(_mm256_srli_epi32(x, 1), _mm256_set1_epi32(0x55555555)));
+        x = _mm256_add_epi32(_mm256_and_si256(x, _mm256_set1_epi32(0x33333333)),
+                             _mm256_and_si256(_mm256_srli_epi32(x, 2), _mm256_set1_epi32(0x33333333)));
+        x = _mm256_and_si256(_mm256_add_epi32(x, _mm256_srli_epi32(x, 4)), _mm256_set1_epi32(0x0F0F0F0F));
+        x = _mm256_add_epi32(x, _mm256_srli_epi32(x, 8));
+        x = _mm256_add_epi32(x, _mm256_srli_epi32(x, 16));
+        return _mm256_and_si256(x, _mm256_set1_epi32(0x3F));
+    }
+
+    CHECKERS_TARGET_AVX2 static inline __m256i steps_avx2(const __m256i pieces, const __m256i empty, const bool up)
+    {
+        const __m256i even = _mm256_and_si256(pieces, _mm256_set1_epi32(int(EVEN_ROWS & NOT_ROW_END)));
+        const __m256i odd = _mm256_and_si256(pieces, _mm256_set1_epi32(int(ODD_ROWS & NOT_ROW_START)));
+        const __m256i a = up ? _mm256_srli_epi32(pieces, 4) : _mm256_slli_epi32(pieces, 4);
+        const __m256i b = up ? _mm256_srli_epi32(even, 3) : _mm256_slli_epi32(even, 5);
+        const __m256i c = up ? _mm256_srli_epi32(odd, 5) : _mm256_slli_epi32(odd, 3);
+        return _mm256_add_epi32(_mm256_add_epi32(popcount_avx2(_mm256_and_si256(a, empty)),
+                                                 popcount_avx2(_mm256_and_si256(b, empty))),
+                                popcount_avx2(_mm256_and_si256(c, empty)));
+    }
+
+    CHECKERS_TARGET_AVX2 static inline __m256i side_score_avx2(const __m256i pieces, const __m256i kings,
+                                                               const __m256i empty, const bool side,
+                                                               const EvalWeights& w)
+    {
+        const __m256i men = _mm256_andnot_si256(kings, pieces);
+        const __m256i n_men = popcount_avx2(men);
+        const __m256i n_kings = popcount_avx2(_mm256_and_si256(pieces, kings));
+        __m256i rows = popcount_avx2(_mm256_and_si256(men, _mm256_set1_epi32(int(ROW_BIT0))));
+        rows = _mm256_add_epi32(rows,
+                                _mm256_slli_epi32(popcount_avx2(_mm256_and_si256(men, _mm256_set1_epi32(int(ROW_BIT1)))), 1));
+        rows = _mm256_add_epi32(rows,
+                                _mm256_slli_epi32(popcount_avx2(_mm256_and_si256(men, _mm256_set1_epi32(int(ROW_BIT2)))), 2));
+        const __m256i advance = side ? rows : _mm256_sub_epi32(_mm256_mullo_epi32(n_men, _mm256_set1_epi32(7)), rows);
+        __m256i res = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(n_men, _mm256_set1_epi32(w.man)),
+                                                        _mm256_mullo_epi32(n_kings, _mm256_set1_epi32(w.king))),
+                                       _mm256_mullo_epi32(advance, _mm256_set1_epi32(w.advance)));
+        if (!w.has_positional())
+            return res;
+        const __m256i center = popcount_avx2(_mm256_and_si256(pieces, _mm256_set1_epi32(int(CENTER_MASK))));
+        const __m256i back =
+            popcount_avx2(_mm256_and_si256(men, _mm256_set1_epi32(int(side ? BACK_RANK_BLACK : BACK_RANK_WHITE))));
+        const __m256i own_kings = _mm256_and_si256(pieces, kings);
+        const __m256i steps = _mm256_add_epi32(steps_avx2(side ? own_kings : pieces, empty, true),
+                                               steps_avx2(side ? pieces : own_kings, empty, false));
+        res = _mm256_add_epi32(res, _mm256_add_epi32(_mm256_mullo_epi32(center, _mm256_set1_epi32(w.center)),
+                                                     _mm256_mullo_epi32(back, _mm256_set1_epi32(w.back_rank))));
+        return _mm256_add_epi32(res, _mm256_mullo_epi32(steps, _mm256_set1_epi32(w.mobility)));
+    }
+
+    // Возвращает число оценённых позиций (кратное 8). Маски 8 позиций собираются одной инструкцией
+    // выборки (gather) с шагом sizeof(Position)
+    CHECKERS_TARGET_AVX2 static int evaluate_avx2(const Position* p, const int count, const EvalWeights& w,
+                                                  int* scores)
+    {
+        const int stride = int(sizeof(Position) / sizeof(int32_t));
+        const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i white = _mm256_i32gather_epi32(reinterpret_cast<const int*>(&p[i].white), offsets, 4);
+            const __m256i black = _mm256_i32gather_epi32(reinterpret_cast<const int*>(&p[i].black), offsets, 4);
+            const __m256i kings = _mm256_i32gather_epi32(reinterpret_cast<const int*>(&p[i].kings), offsets, 4);
+            const __m256i black_turn = _mm256_setr_epi32(-int(p[i].color), -int(p[i + 1].color), -int(p[i + 2].color),
+                                                         -int(p[i + 3].color), -int(p[i + 4].color),
+                                                         -int(p[i + 5].color), -int(p[i + 6].color),
+                                                         -int(p[i + 7].color));
+
+            const __m256i empty = _mm256_xor_si256(_mm256_or_si256(white, black), _mm256_set1_epi32(-1));
+            const __m256i diff = _mm256_sub_epi32(side_score_avx2(white, kings, empty, 0, w),
+                                                  side_score_avx2(black, kings, empty, 1, w));
+            __m256i res = _mm256_sub_epi32(_mm256_xor_si256(diff, black_turn), black_turn);
+
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i own = _mm256_blendv_epi8(white, black, black_turn);
+            const __m256i enemy = _mm256_blendv_epi8(black, white, black_turn);
+            res = _mm256_blendv_epi8(res, _mm256_set1_epi32(WIN_SCORE), _mm256_cmpeq_epi32(enemy, zero));
+            res = _mm256_blendv_epi8(res, _mm256_set1_epi32(-WIN_SCORE), _mm256_cmpeq_epi32(own, zero));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(scores + i), res);
+        }
+        return i;
+    }
+#endif
+};
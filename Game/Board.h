@@ -6,6 +6,8 @@
 
 #include "../Models/Move.h"         // Структура хода
 #include "../Models/Project_path.h" // Путь к ресурсам
+#include "GameState.h"              // Отображаемое состояние партии
+#include "Trace.h"                  // Замеры этапов отрисовки
 
 // Подключение SDL с учётом платформы
 #ifdef __APPLE__
@@ -18,14 +20,15 @@
 
 using namespace std;
 
-// Класс Board — управляет графикой, состоянием доски и логикой визуализации
+// Класс Board — отображает состояние партии (GameState): окно, текстуры, подсветка ходов.
+// Изменения подсветки и выделения только помечают кадр устаревшим; кадр рисуется и выводится один раз
+// в flush() — перед ожиданием ввода и после каждого хода. Фон и кнопки нарисованы заранее
+// в текстуре-слое, все текстуры загружаются один раз при запуске
 class Board
 {
 public:
-    Board() = default;
-
-    // Конструктор с установкой размеров окна
-    Board(const unsigned int W, const unsigned int H) : W(W), H(H) {}
+    // Конструктор с установкой отображаемого состояния и размеров окна
+    Board(const GameState* state, const unsigned int W, const unsigned int H) : W(W), H(H), state(state) {}
 
     // Инициализация SDL, создание окна и загрузка всех текстур
     int start_draw()
@@ -65,82 +68,57 @@ public:
             return 1;
         }
 
-        // Загрузка текстур фона, шашек, дамок и кнопок
-        board = IMG_LoadTexture(ren, board_path.c_str());
-        w_piece = IMG_LoadTexture(ren, piece_white_path.c_str());
-        b_piece = IMG_LoadTexture(ren, piece_black_path.c_str());
-        w_queen = IMG_LoadTexture(ren, queen_white_path.c_str());
-        b_queen = IMG_LoadTexture(ren, queen_black_path.c_str());
-        back = IMG_LoadTexture(ren, back_path.c_str());
-        replay = IMG_LoadTexture(ren, replay_path.c_str());
+        // Загрузка текстур фона, шашек, дамок, кнопок и итогов партии
+        {
+            TraceScope scope("load_textures");
+            board = IMG_LoadTexture(ren, board_path.c_str());
+            w_piece = IMG_LoadTexture(ren, piece_white_path.c_str());
+            b_piece = IMG_LoadTexture(ren, piece_black_path.c_str());
+            w_queen = IMG_LoadTexture(ren, queen_white_path.c_str());
+            b_queen = IMG_LoadTexture(ren, queen_black_path.c_str());
+            back = IMG_LoadTexture(ren, back_path.c_str());
+            replay = IMG_LoadTexture(ren, replay_path.c_str());
+            draw_result = IMG_LoadTexture(ren, draw_path.c_str());
+            white_result = IMG_LoadTexture(ren, white_path.c_str());
+            black_result = IMG_LoadTexture(ren, black_path.c_str());
+        }
 
         if (!board || !w_piece || !b_piece || !w_queen || !b_queen || !back || !replay)
         {
             print_exception("IMG_LoadTexture can't load main textures from " + textures_path);
             return 1;
         }
+        if (!draw_result || !white_result || !black_result)
+            print_exception("IMG_LoadTexture can't load game result pictures from " + textures_path);
 
-        SDL_GetRendererOutputSize(ren, &W, &H);
-        make_start_mtx();
-        rerender();
+        reset_window_size();
+        flush();
         return 0;
     }
 
-    // Сброс состояния доски (перезапуск игры)
+    // Сброс отображения: результат партии, подсветка и выделение (перезапуск игры или откат хода)
     void redraw()
     {
         game_results = -1;
-        history_mtx.clear();
-        history_beat_series.clear();
-        make_start_mtx();
         clear_active();
         clear_highlight();
+        flush();
     }
 
-    // Ход с возможным взятием
-    void move_piece(move_pos turn, const int beat_series = 0)
-    {
-        if (turn.xb != -1)
-            mtx[turn.xb][turn.yb] = 0;
-        move_piece(turn.x, turn.y, turn.x2, turn.y2, beat_series);
-    }
-
-    // Ход по координатам
-    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
+    // Перерисовка после изменения состояния партии (каждый шаг хода виден отдельно)
+    void update()
     {
-        if (mtx[i2][j2])
-            throw runtime_error("final position is not empty, can't move");
-        if (!mtx[i][j])
-            throw runtime_error("begin position is empty, can't move");
-
-        if ((mtx[i][j] == 1 && i2 == 0) || (mtx[i][j] == 2 && i2 == 7))
-            mtx[i][j] += 2; // Превращение в дамку
-
-        mtx[i2][j2] = mtx[i][j];
-        drop_piece(i, j);
-        add_history(beat_series);
-    }
-
-    // Удаление шашки
-    void drop_piece(const POS_T i, const POS_T j)
-    {
-        mtx[i][j] = 0;
-        rerender();
+        dirty = true;
+        flush();
     }
 
-    // Превращение в дамку
-    void turn_into_queen(const POS_T i, const POS_T j)
+    // Вывод кадра, если с прошлого вывода что-то изменилось
+    void flush()
     {
-        if (mtx[i][j] == 0 || mtx[i][j] > 2)
-            throw runtime_error("can't turn into queen in this position");
-        mtx[i][j] += 2;
+        if (!dirty || !ren)
+            return;
         rerender();
-    }
-
-    // Получить состояние доски
-    vector<vector<POS_T>> get_board() const
-    {
-        return mtx;
+        dirty = false;
     }
 
     // Подсветка возможных ходов
@@ -148,7 +126,7 @@ public:
     {
         for (auto pos : cells)
             is_highlighted_[pos.first][pos.second] = 1;
-        rerender();
+        dirty = true;
     }
 
     // Сброс подсветки
@@ -156,7 +134,7 @@ public:
     {
         for (POS_T i = 0; i < 8; ++i)
             is_highlighted_[i].assign(8, 0);
-        rerender();
+        dirty = true;
     }
 
     // Установка активной (выделенной) клетки
@@ -164,7 +142,7 @@ public:
     {
         active_x = x;
         active_y = y;
-        rerender();
+        dirty = true;
     }
 
     // Сброс выделенной клетки
@@ -172,7 +150,7 @@ public:
     {
         active_x = -1;
         active_y = -1;
-        rerender();
+        dirty = true;
     }
 
     // Проверка на подсветку клетки
@@ -181,37 +159,34 @@ public:
         return is_highlighted_[x][y];
     }
 
-    // Откат последнего (или нескольких) ходов
-    void rollback()
-    {
-        auto beat_series = max(1, *(history_beat_series.rbegin()));
-        while (beat_series-- && history_mtx.size() > 1)
-        {
-            history_mtx.pop_back();
-            history_beat_series.pop_back();
-        }
-        mtx = *(history_mtx.rbegin());
-        clear_highlight();
-        clear_active();
-    }
-
     // Отображение результата игры
     void show_final(const int res)
     {
         game_results = res;
-        rerender();
+        dirty = true;
     }
 
-    // Обработка изменения размера окна
+    // Обработка изменения размера окна (и потери содержимого текстур-слоёв): слой строится заново
     void reset_window_size()
     {
         SDL_GetRendererOutputSize(ren, &W, &H);
-        rerender();
+        build_layer();
+        dirty = true;
+    }
+
+    // Кадр нужно вывести заново (например, окно было перекрыто)
+    void invalidate()
+    {
+        dirty = true;
     }
 
     // Очистка всех ресурсов SDL
     void quit()
     {
+        SDL_DestroyTexture(layer);
+        SDL_DestroyTexture(draw_result);
+        SDL_DestroyTexture(white_result);
+        SDL_DestroyTexture(black_result);
         SDL_DestroyTexture(board);
         SDL_DestroyTexture(w_piece);
         SDL_DestroyTexture(b_piece);
@@ -232,36 +207,46 @@ public:
     }
 
 private:
-    // Добавление текущего состояния доски в историю
-    void add_history(const int beat_series = 0)
-    {
-        history_mtx.push_back(mtx);
-        history_beat_series.push_back(beat_series);
-    }
-
-    // Начальная расстановка фигур
-    void make_start_mtx()
+    // Неизменная часть кадра — фон и кнопки — в текстуре размером с окно.
+    // Если рендерер не умеет рисовать в текстуру, она рисуется прямо в кадре
+    void build_layer()
     {
-        for (POS_T i = 0; i < 8; ++i)
+        TraceScope scope("build_layer");
+        SDL_DestroyTexture(layer);
+        layer = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, W, H);
+        if (!layer)
+            return;
+        if (SDL_SetRenderTarget(ren, layer) != 0)
         {
-            for (POS_T j = 0; j < 8; ++j)
-            {
-                mtx[i][j] = 0;
-                if (i < 3 && (i + j) % 2 == 1)
-                    mtx[i][j] = 2; // Чёрные
-                if (i > 4 && (i + j) % 2 == 1)
-                    mtx[i][j] = 1; // Белые
-            }
+            SDL_DestroyTexture(layer);
+            layer = nullptr;
+            return;
         }
-        add_history();
+        draw_static();
+        SDL_SetRenderTarget(ren, NULL);
     }
 
-    // Полная перерисовка поля и всех элементов
-    void rerender()
+    // Фон поля и кнопки "Назад" и "Сыграть заново"
+    void draw_static()
     {
         SDL_RenderClear(ren);
         SDL_RenderCopy(ren, board, NULL, NULL);
+        SDL_Rect rect_left{ W / 40, H / 40, W / 15, H / 15 };
+        SDL_RenderCopy(ren, back, NULL, &rect_left);
+        SDL_Rect replay_rect{ W * 109 / 120, H / 40, W / 15, H / 15 };
+        SDL_RenderCopy(ren, replay, NULL, &replay_rect);
+    }
+
+    // Рисование кадра: слой фона, фигуры, подсветка, итог партии — и один вывод на экран
+    void rerender()
+    {
+        TraceScope scope("rerender");
+        if (layer)
+            SDL_RenderCopy(ren, layer, NULL, NULL);
+        else
+            draw_static();
 
+        const auto& mtx = state->get_board();
         for (POS_T i = 0; i < 8; ++i)
         {
             for (POS_T j = 0; j < 8; ++j)
@@ -300,32 +285,19 @@ private:
         }
         SDL_RenderSetScale(ren, 1, 1);
 
-        SDL_Rect rect_left{ W / 40, H / 40, W / 15, H / 15 };
-        SDL_RenderCopy(ren, back, NULL, &rect_left);
-        SDL_Rect replay_rect{ W * 109 / 120, H / 40, W / 15, H / 15 };
-        SDL_RenderCopy(ren, replay, NULL, &replay_rect);
-
         if (game_results != -1)
         {
-            string result_path = draw_path;
-            if (game_results == 1) result_path = white_path;
-            else if (game_results == 2) result_path = black_path;
+            SDL_Texture* result_texture = draw_result;
+            if (game_results == 1) result_texture = white_result;
+            else if (game_results == 2) result_texture = black_result;
 
-            SDL_Texture* result_texture = IMG_LoadTexture(ren, result_path.c_str());
-            if (!result_texture)
-            {
-                print_exception("IMG_LoadTexture can't load game result picture from " + result_path);
-                return;
-            }
             SDL_Rect res_rect{ W / 5, H * 3 / 10, W * 3 / 5, H * 2 / 5 };
-            SDL_RenderCopy(ren, result_texture, NULL, &res_rect);
-            SDL_DestroyTexture(result_texture);
+            if (result_texture)
+                SDL_RenderCopy(ren, result_texture, NULL, &res_rect);
         }
 
         SDL_RenderPresent(ren);
-        SDL_Delay(10);
-        SDL_Event windowEvent;
-        SDL_PollEvent(&windowEvent);
+        SDL_PumpEvents(); // Окно отвечает системе и во время хода бота; события остаются в очереди
     }
 
     // Логирование ошибок в файл
@@ -337,13 +309,15 @@ private:
 
 public:
     int W = 0, H = 0; // Размеры окна
-    vector<vector<vector<POS_T>>> history_mtx; // История ходов
 
 private:
+    const GameState* state; // Отображаемое состояние партии
     SDL_Window *win = nullptr;
     SDL_Renderer *ren = nullptr;
     SDL_Texture *board = nullptr, *w_piece = nullptr, *b_piece = nullptr;
     SDL_Texture *w_queen = nullptr, *b_queen = nullptr, *back = nullptr, *replay = nullptr;
+    SDL_Texture *draw_result = nullptr, *white_result = nullptr, *black_result = nullptr;
+    SDL_Texture *layer = nullptr; // Фон и кнопки под текущий размер окна
 
     const string textures_path = project_path + "Textures/";
     const string board_path = textures_path + "board.png";
@@ -359,8 +333,7 @@ private:
 
     int active_x = -1, active_y = -1;
     int game_results = -1;
+    bool dirty = true; // Кадр на экране устарел
 
     vector<vector<bool>> is_highlighted_ = vector<vector<bool>>(8, vector<bool>(8, 0));
-    vector<vector<POS_T>> mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
-    vector<int> history_beat_series;
 };
@@ -30,6 +30,12 @@ public:
         return config[setting_dir][setting_name];
     }
 
+    // Переопределение настройки только в памяти (файл не меняется) — для консольных инструментов
+    void set(const string& setting_dir, const string& setting_name, const json& value)
+    {
+        config[setting_dir][setting_name] = value;
+    }
+
 private:
     json config;  // Переменная, хранящая содержимое файла настроек
 };
@@ -0,0 +1,132 @@
+﻿// Поток движка: поиск хода бота идёт не в потоке окна, а в отдельном потоке по очереди запросов.
+// Окно тем временем обрабатывает события и рисуется; результат забирается из очереди результатов,
+// а запрос можно отменить — поиск прерывается за несколько узлов (Logic::cancel)
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+
+#include "../Models/Move.h"
+#include "../Models/Position.h"
+#include "Logic.h"
+
+using namespace std;
+
+// Запрос хода бота для позиции pos (глубина и остальные настройки — текущие настройки Logic)
+struct EngineRequest
+{
+    uint64_t id = 0;
+    Position pos;
+};
+
+// Ответ на запрос id; отменённые запросы ответа не получают
+struct EngineResult
+{
+    uint64_t id = 0;
+    chain_move turn; // Лучший ход (from == -1, если ходов нет)
+};
+
+class EngineWorker
+{
+public:
+    explicit EngineWorker(Logic* logic) : logic(logic), worker(&EngineWorker::run, this)
+    {
+    }
+
+    ~EngineWorker()
+    {
+        {
+            lock_guard<mutex> lock(mtx);
+            quit = true;
+            requests.clear();
+            if (busy)
+                logic->cancel();
+        }
+        request_cv.notify_one();
+        worker.join();
+    }
+
+    // Постановка запроса в очередь; возвращает номер запроса для сверки с результатом
+    uint64_t submit(const Position& pos)
+    {
+        uint64_t id;
+        {
+            lock_guard<mutex> lock(mtx);
+            id = ++last_id;
+            requests.push_back(EngineRequest{ id, pos });
+        }
+        request_cv.notify_one();
+        return id;
+    }
+
+    // Готовый результат, если он есть (без ожидания)
+    bool poll(EngineResult& res)
+    {
+        lock_guard<mutex> lock(mtx);
+        if (results.empty())
+            return false;
+        res = results.front();
+        results.pop_front();
+        return true;
+    }
+
+    // Отмена всех запросов: текущий поиск прерывается, ожидающие и готовые результаты отбрасываются.
+    // Возвращается, когда поток движка свободен — после этого Logic можно менять из потока окна
+    void cancel()
+    {
+        unique_lock<mutex> lock(mtx);
+        requests.clear();
+        if (busy)
+            logic->cancel();
+        idle_cv.wait(lock, [this]() { return !busy; });
+        results.clear();
+    }
+
+public:
+    function<void()> on_result; // Вызывается из потока движка, когда результат поставлен в очередь
+
+private:
+    void run()
+    {
+        while (true)
+        {
+            EngineRequest request;
+            {
+                unique_lock<mutex> lock(mtx);
+                request_cv.wait(lock, [this]() { return quit || !requests.empty(); });
+                if (quit)
+                    return;
+                request = requests.front();
+                requests.pop_front();
+                busy = true;
+                logic->reset_cancel(); // Под той же блокировкой, что и cancel(), — отмена не потеряется
+            }
+
+            const chain_move turn = logic->find_best_turn(request.pos);
+
+            {
+                lock_guard<mutex> lock(mtx);
+                busy = false;
+                if (!logic->is_cancelled())
+                    results.push_back(EngineResult{ request.id, turn });
+            }
+            idle_cv.notify_all();
+            if (on_result)
+                on_result();
+        }
+    }
+
+private:
+    Logic* logic;
+    mutex mtx; // Защищает очереди и флаги
+    condition_variable request_cv, idle_cv;
+    deque<EngineRequest> requests;
+    deque<EngineResult> results;
+    uint64_t last_id = 0;
+    bool busy = false; // Идёт поиск
+    bool quit = false;
+    thread worker; // Последним: поток запускается, когда остальные поля готовы
+};
@@ -1,22 +1,28 @@
 ﻿#pragma once
 #include <chrono>       // Для измерения времени
+#include <optional>     // Замер задержки хода бота
 #include <thread>       // Для задержки выполнения
 
 #include "../Models/Project_path.h"  // Путь к папке проекта
 #include "Board.h"       // Класс игрового поля
 #include "Config.h"      // Работа с настройками из JSON
+#include "EngineWorker.h" // Поиск хода бота в отдельном потоке
+#include "GameState.h"   // Состояние партии
 #include "Hand.h"        // Управление взаимодействием с игроком
 #include "Logic.h"       // Логика игры (поиск ходов, проверка победы и т.д.)
+#include "StatsLog.h"    // Журнал статистики поиска
+#include "Trace.h"       // Трассировка этапов партии
 
 
 class Game
 {
 public:
-    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(&board, &config)
+    Game()
+        : board(&state, config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board, &state),
+          logic(&state, &config), engine(&logic), stats_log(project_path + "log.jsonl")
     {
-        // При запуске очищаем лог-файл
-        ofstream fout(project_path + "log.txt", ios_base::trunc);
-        fout.close();
+        logic.on_search_done = Hand::notify_engine; // Завершение фонового поиска будит ожидание ввода
+        engine.on_result = Hand::notify_engine;
     }
 
     int play()
@@ -25,8 +31,17 @@ public:
 
         if (is_replay)
         {
-            logic = Logic(&board, &config); // Сброс логики для новой игры
+            logic.reset();                  // Сброс логики для новой игры
+            logic.on_search_done = Hand::notify_engine;
             config.reload();                // Перезагрузка настроек
+            state.reset();                  // Начальная расстановка
+        }
+        // Трассировка этапов партии (Game.TracePath); файл пишется в конце партии
+        const string trace_path = config("Game", "TracePath");
+        Trace::enable(!trace_path.empty());
+        const uint64_t trace_start = Trace::now_ns();
+        if (is_replay)
+        {
             board.redraw();                 // Перерисовка поля
         }
         else
@@ -37,11 +52,17 @@ public:
 
         int turn_num = -1;                       // Счётчик ходов
         bool is_quit = false;                    // Флаг выхода
+        bool is_repetition = false;              // Позиция повторилась в третий раз — ничья
         const int Max_turns = config("Game", "MaxNumTurns"); // Макс. количество ходов
 
         while (++turn_num < Max_turns)
         {
             beat_series = 0;                         // Обнуляем счётчик ударов
+            if (state.repetitions() >= 2)
+            {
+                is_repetition = true;
+                break;
+            }
             logic.find_turns(turn_num % 2);          // Поиск ходов для текущего игрока (0 – белый, 1 – чёрный)
             if (logic.turns.empty())
                 break; // Нет ходов — завершение игры
@@ -52,6 +73,7 @@ public:
             if (!config("Bot", string("Is") + string((turn_num % 2) ? "Black" : "White") + "Bot"))
             {
                 auto resp = player_turn(turn_num % 2); // Выполняем ход игрока
+                logic.stop_ponder();                   // Поиск на время игрока больше не нужен
 
                 if (resp == Response::QUIT)
                 {
@@ -67,31 +89,64 @@ public:
                 {
                     // Откат ходов при определённых условиях
                     if (config("Bot", string("Is") + string((1 - turn_num % 2) ? "Black" : "White") + "Bot") &&
-                        !beat_series && board.history_mtx.size() > 2)
+                        !beat_series && state.ply() > 1)
                     {
-                        board.rollback();
+                        state.rollback();
                         --turn_num;
                     }
                     if (!beat_series)
                         --turn_num;
 
-                    board.rollback();
+                    state.rollback();
+                    board.redraw();
                     --turn_num;
                     beat_series = 0;
                 }
             }
             else
             {
-                bot_turn(turn_num % 2); // Ход делает бот
+                auto resp = bot_turn(turn_num % 2); // Ход делает бот
+                if (resp == Response::QUIT)
+                {
+                    is_quit = true;
+                    break;
+                }
+                else if (resp == Response::REPLAY)
+                {
+                    is_replay = true;
+                    break;
+                }
+                else if (resp == Response::BACK)
+                {
+                    // Поиск прерван, отменяется предыдущий ход — его сторона ходит снова
+                    state.rollback();
+                    board.redraw();
+                    turn_num -= 2;
+                    continue;
+                }
+                // Пока думает игрок, бот ищет ответы на его ходы
+                if (config("Bot", "Ponder") &&
+                    !config("Bot", string("Is") + string((1 - turn_num % 2) ? "Black" : "White") + "Bot"))
+                    logic.start_ponder(state.get_position(1 - turn_num % 2));
             }
         }
+        logic.stop_ponder();
 
         auto end = chrono::steady_clock::now(); // Засекаем окончание игры
 
         // Логируем продолжительность всей партии
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Game time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
-        fout.close();
+        json record;
+        record["event"] = "game";
+        record["time_ms"] = chrono::duration<double, milli>(end - start).count();
+        record["plies"] = state.ply();
+        stats_log.write(record);
+        stats_log.flush();
+        if (!trace_path.empty())
+        {
+            // Потоки поиска к этому моменту остановлены — кольца событий можно читать
+            Trace::record("game", trace_start, Trace::now_ns());
+            Trace::dump(project_path + trace_path, trace_start);
+        }
 
         if (is_replay)
             return play(); // Перезапуск
@@ -100,7 +155,7 @@ public:
 
         // Определяем результат
         int res = 2;
-        if (turn_num == Max_turns)
+        if (turn_num == Max_turns || is_repetition)
             res = 0; // Ничья
         else if (turn_num % 2)
             res = 1; // Победа чёрных
@@ -119,32 +174,86 @@ public:
 
 
   private:
-      void bot_turn(const bool color)
+      // Ход бота. Поиск идёт в потоке движка, а окно всё это время обрабатывает события:
+      // выход, новая игра и откат прерывают поиск. Возвращает Response::OK, когда ход сделан
+      Response bot_turn(const bool color)
       {
+          TraceScope scope("bot_turn");
           auto start = chrono::steady_clock::now(); // Засекаем время хода бота
+          const size_t ply = state.ply();
+
+          const int delay_ms = config("Bot", "BotDelayMS");
+          const auto delay_end = start + chrono::milliseconds(delay_ms); // Задержка — имитация размышления
+          const uint64_t request = engine.submit(state.get_position(color)); // Поиск оптимального хода
+          EngineResult result;
+          bool ready = false;
+          optional<TraceScope> delay_scope; // Ход найден, идёт задержка BotDelayMS
+          while (true)
+          {
+              while (!ready && engine.poll(result))
+                  ready = result.id == request;
+              const auto now = chrono::steady_clock::now();
+              if (ready && now >= delay_end)
+                  break;
+              if (ready && !delay_scope)
+                  delay_scope.emplace("bot_delay");
+              const int timeout_ms = ready ? int(chrono::duration_cast<chrono::milliseconds>(delay_end - now).count()) + 1
+                                           : 100; // Результат поиска будит ожидание событием Hand::engine_event
+              const Response resp = hand.wait_event(timeout_ms);
+              if (resp == Response::QUIT || resp == Response::REPLAY || resp == Response::BACK)
+              {
+                  engine.cancel();
+                  return resp;
+              }
+          }
 
-          auto delay_ms = config("Bot", "BotDelayMS");
-          thread th(SDL_Delay, delay_ms); // Задержка — имитация размышления
-          auto turns = logic.find_best_turns(color); // Поиск оптимального хода
-          th.join(); // Дожидаемся окончания задержки
+          delay_scope.reset();
 
+          // Ход воспроизводится по шагам его пути
           bool is_first = true;
-          for (auto turn : turns)
+          for (auto turn : chain_hops(result.turn))
           {
               if (!is_first)
               {
-                  SDL_Delay(delay_ms); // Задержка между последовательными ударами
+                  // Задержка между последовательными ударами
+                  const Response resp = pause(delay_ms);
+                  if (resp != Response::OK)
+                      return resp;
               }
               is_first = false;
               beat_series += (turn.xb != -1); // Учёт удара
-              board.move_piece(turn, beat_series); // Выполнение хода
+              state.move_piece(turn, beat_series); // Выполнение хода
+              board.update();
           }
 
           auto end = chrono::steady_clock::now();
-          // Логирование времени хода бота
-          ofstream fout(project_path + "log.txt", ios_base::app);
-          fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
-          fout.close();
+          // Логирование хода бота: время с показом хода и счётчики поиска
+          json record = StatsLog::search_record(logic.stats);
+          record["event"] = "bot_turn";
+          record["ply"] = ply;
+          record["color"] = color ? "black" : "white";
+          record["turn_ms"] = chrono::duration<double, milli>(end - start).count();
+          record["depth"] = logic.completed_depth;
+          record["score"] = logic.best_score;
+          record["book"] = logic.from_book;
+          record["ponder"] = logic.from_ponder;
+          stats_log.write(record);
+          return Response::OK;
+      }
+
+      // Пауза с обработкой событий окна; прерывается только выходом или новой игрой
+      Response pause(const int ms)
+      {
+          TraceScope scope("hop_delay");
+          const auto end = chrono::steady_clock::now() + chrono::milliseconds(ms);
+          for (auto now = chrono::steady_clock::now(); now < end; now = chrono::steady_clock::now())
+          {
+              const Response resp =
+                  hand.wait_event(int(chrono::duration_cast<chrono::milliseconds>(end - now).count()) + 1);
+              if (resp == Response::QUIT || resp == Response::REPLAY)
+                  return resp;
+          }
+          return Response::OK;
       }
 
 
@@ -153,6 +262,7 @@ public:
       // либо Response::QUIT / REPLAY / BACK при соответствующем действии игрока.
       Response player_turn(const bool color)
       {
+          TraceScope scope("player_turn");
           // Создаём вектор координат фигур, которые можно двигать
           vector<pair<POS_T, POS_T>> cells;
           for (auto turn : logic.turns)
@@ -175,6 +285,8 @@ public:
           while (true)
           {
               auto resp = hand.get_cell(); // Получаем выбор игрока
+              if (get<0>(resp) == Response::ENGINE)
+                  continue; // Поиск на время игрока закончился — ход всё ещё за игроком
               if (get<0>(resp) != Response::CELL)
                   return get<0>(resp); // Обработка других действий: выход, повтор и т.п.
 
@@ -230,7 +342,8 @@ public:
 
           board.clear_highlight();
           board.clear_active();
-          board.move_piece(pos, pos.xb != -1);
+          state.move_piece(pos, pos.xb != -1);
+          board.update();
           if (pos.xb == -1)
               return Response::OK;
 
@@ -253,6 +366,8 @@ public:
               while (true)
               {
                   auto resp = hand.get_cell();
+                  if (get<0>(resp) == Response::ENGINE)
+                      continue;
                   if (get<0>(resp) != Response::CELL)
                       return get<0>(resp);
 
@@ -275,7 +390,8 @@ public:
                   board.clear_highlight();
                   board.clear_active();
                   beat_series += 1;
-                  board.move_piece(pos, beat_series);
+                  state.move_piece(pos, beat_series);
+                  board.update();
                   break;
               }
           }
@@ -285,9 +401,12 @@ public:
 
 private:
     Config config;    // Настройки из settings.json
-    Board board;      // Игровое поле
+    GameState state;  // Состояние партии (без графики)
+    Board board;      // Игровое поле (отображение state)
     Hand hand;        // Ввод от игрока
     Logic logic;      // Расчёт ходов
+    EngineWorker engine; // Поток поиска хода бота (после logic: останавливается раньше, чем она разрушается)
+    StatsLog stats_log;  // Журнал ходов бота и партий (log.jsonl)
     int beat_series;  // Количество последовательных ударов
     bool is_replay = false; // Флаг повторной игры
 };
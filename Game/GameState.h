@@ -0,0 +1,205 @@
+﻿// Класс GameState — состояние партии без графики: расстановка фигур, ходы и история для отката.
+// Board только отображает это состояние, а Logic и консольные инструменты работают с ним без SDL.
+// История — журнал шагов фиксированного размера (MoveRecord) с Zobrist-ключом расстановки после каждого:
+// откат шага и повтор отменённого стоят O(1), переход к любому полуходу — по шагу за раз
+#pragma once
+#include <stdexcept>   // Для ошибок некорректных ходов
+#include <stdint.h>
+#include <vector>      // Для хранения состояния доски и истории
+
+#include "../Models/Move.h"     // Структура хода
+#include "../Models/Position.h" // Упакованная позиция для поиска
+#include "../Models/Zobrist.h"  // Ключи хеширования позиции
+
+using namespace std;
+
+// Запись журнала партии: один шаг хода (при серии взятий — один удар) и ключ расстановки после него
+struct MoveRecord
+{
+    POS_T x, y, x2, y2;       // Откуда и куда
+    POS_T xb, yb;             // Побитая фигура (-1, если шаг без взятия)
+    uint8_t piece : 3;        // Тип фигуры до шага (1..4, как в матрице доски)
+    uint8_t captured : 3;     // Тип побитой фигуры (0 — без взятия)
+    uint8_t promoted : 1;     // Шаг закончился превращением в дамку
+    uint8_t beat_series;      // Номер удара в серии взятий (0 — шаг без взятия)
+    uint64_t key;             // Zobrist-ключ расстановки после шага, без очереди хода
+};
+
+class GameState
+{
+public:
+    GameState()
+    {
+        reset();
+    }
+
+    // Начальная расстановка и очистка истории (новая партия)
+    void reset()
+    {
+        history.clear();
+        cursor = 0;
+        make_start_mtx();
+        start_key = 0;
+        for (POS_T i = 0; i < 8; ++i)
+            for (POS_T j = 0; j < 8; ++j)
+                if (mtx[i][j])
+                    start_key ^= piece_key(mtx[i][j], i, j);
+    }
+
+    // Ход с возможным взятием
+    void move_piece(move_pos turn, const int beat_series = 0)
+    {
+        if (mtx[turn.x2][turn.y2])
+            throw runtime_error("final position is not empty, can't move");
+        if (!mtx[turn.x][turn.y])
+            throw runtime_error("begin position is empty, can't move");
+
+        MoveRecord rec;
+        rec.x = turn.x;
+        rec.y = turn.y;
+        rec.x2 = turn.x2;
+        rec.y2 = turn.y2;
+        rec.xb = turn.xb;
+        rec.yb = turn.yb;
+        rec.piece = uint8_t(mtx[turn.x][turn.y]);
+        rec.captured = uint8_t(turn.xb != -1 ? mtx[turn.xb][turn.yb] : 0);
+        rec.promoted = (rec.piece == 1 && turn.x2 == 0) || (rec.piece == 2 && turn.x2 == 7); // Превращение в дамку
+        rec.beat_series = uint8_t(beat_series);
+        rec.key = key() ^ piece_key(rec.piece, rec.x, rec.y) ^ piece_key(rec.piece + 2 * rec.promoted, rec.x2, rec.y2);
+        if (rec.captured)
+            rec.key ^= piece_key(rec.captured, rec.xb, rec.yb);
+
+        history.resize(cursor); // Отменённые шаги после нового хода уже не повторить
+        history.push_back(rec);
+        apply(rec);
+        ++cursor;
+    }
+
+    // Ход по координатам
+    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
+    {
+        move_piece(move_pos(i, j, i2, j2), beat_series);
+    }
+
+    // Получить состояние доски
+    const vector<vector<POS_T>>& get_board() const
+    {
+        return mtx;
+    }
+
+    // Упакованная позиция для поиска, color — чья очередь хода
+    Position get_position(const bool color) const
+    {
+        return Position(mtx, color);
+    }
+
+    // Откат последнего (или нескольких) ходов: серия взятий отменяется целиком
+    void rollback()
+    {
+        if (!cursor)
+            return;
+        int beat_series = max(1, int(history[cursor - 1].beat_series));
+        while (beat_series-- && cursor > 0)
+            undo(history[--cursor]);
+    }
+
+    // Число сделанных шагов (отменённые откатом не считаются)
+    size_t ply() const
+    {
+        return cursor;
+    }
+
+    // Число шагов в журнале, включая отменённые, к которым ещё можно вернуться через seek
+    size_t size() const
+    {
+        return history.size();
+    }
+
+    // Переход к расстановке после ply шагов журнала — назад отменой, вперёд повтором записанных шагов
+    void seek(const size_t ply)
+    {
+        if (ply > history.size())
+            throw runtime_error("can't seek past the end of the game history");
+        while (cursor > ply)
+            undo(history[--cursor]);
+        while (cursor < ply)
+            apply(history[cursor++]);
+    }
+
+    // Zobrist-хеш позиции после ply шагов (в начале партии ходят белые, после шага — соперник
+    // его фигуры), совпадает с Position::hash той же позиции
+    uint64_t hash(const size_t ply) const
+    {
+        if (!ply)
+            return start_key;
+        const MoveRecord& rec = history[ply - 1];
+        return rec.key ^ (rec.piece % 2 ? zobrist.side : 0);
+    }
+
+    // Сколько раз текущая позиция уже встречалась раньше. Взятие и ход простой шашки необратимы,
+    // поэтому поиск идёт назад только до последнего такого шага
+    int repetitions() const
+    {
+        const uint64_t current = hash(cursor);
+        int res = 0;
+        for (size_t ply = cursor; ply > 0; --ply)
+        {
+            const MoveRecord& rec = history[ply - 1];
+            if (rec.captured || rec.piece <= 2)
+                break;
+            if (hash(ply - 1) == current)
+                ++res;
+        }
+        return res;
+    }
+
+private:
+    // Ключ расстановки в текущей точке журнала
+    uint64_t key() const
+    {
+        return cursor ? history[cursor - 1].key : start_key;
+    }
+
+    static uint64_t piece_key(const int type, const POS_T i, const POS_T j)
+    {
+        return zobrist.piece[type - 1][square_index(i, j)];
+    }
+
+    void apply(const MoveRecord& rec)
+    {
+        if (rec.xb != -1)
+            mtx[rec.xb][rec.yb] = 0;
+        mtx[rec.x2][rec.y2] = POS_T(rec.piece + 2 * rec.promoted);
+        mtx[rec.x][rec.y] = 0;
+    }
+
+    void undo(const MoveRecord& rec)
+    {
+        mtx[rec.x2][rec.y2] = 0;
+        mtx[rec.x][rec.y] = POS_T(rec.piece);
+        if (rec.xb != -1)
+            mtx[rec.xb][rec.yb] = POS_T(rec.captured);
+    }
+
+    // Начальная расстановка фигур
+    void make_start_mtx()
+    {
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                mtx[i][j] = 0;
+                if (i < 3 && (i + j) % 2 == 1)
+                    mtx[i][j] = 2; // Чёрные
+                if (i > 4 && (i + j) % 2 == 1)
+                    mtx[i][j] = 1; // Белые
+            }
+        }
+    }
+
+private:
+    vector<vector<POS_T>> mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
+    vector<MoveRecord> history; // Журнал шагов партии
+    size_t cursor = 0;          // Число применённых шагов журнала
+    uint64_t start_key = 0;     // Ключ начальной расстановки
+};
@@ -4,132 +4,138 @@
 #include "../Models/Move.h"
 #include "../Models/Response.h"
 #include "Board.h"
+#include "GameState.h"
 
-// Класс Hand — отвечает за обработку ввода от пользователя (мышь, выход, кнопки)
+// Класс Hand — отвечает за обработку ввода от пользователя (мышь, выход, кнопки).
+// Ввод ждётся блокирующе (SDL_WaitEventTimeout), поэтому пока игрок думает, процессор свободен
 class Hand
 {
 public:
-    // Конструктор: получает указатель на игровое поле
-    Hand(Board* board) : board(board)
+    // Конструктор: получает указатели на игровое поле и состояние партии
+    Hand(Board* board, const GameState* state) : board(board), state(state)
     {
     }
 
+    // Тип события SDL "поиск завершён": поток поиска будит им ожидание ввода
+    static Uint32 engine_event()
+    {
+        static const Uint32 type = SDL_RegisterEvents(1);
+        return type;
+    }
+
+    // Сообщение о завершении поиска; можно вызывать из любого потока
+    static void notify_engine()
+    {
+        SDL_Event event = {};
+        event.type = engine_event();
+        SDL_PushEvent(&event);
+    }
+
     // Метод get_cell() — возвращает кортеж:
-    // (ответ пользователя, координата X, координата Y)
+    // (ответ пользователя, координата X, координата Y).
+    // Response::ENGINE — поиск бота завершился, пока игрок выбирал ход
     tuple<Response, POS_T, POS_T> get_cell() const
     {
-        SDL_Event windowEvent;
-        Response resp = Response::OK;  // Начальное состояние
-        int x = -1, y = -1;            // Координаты в пикселях
-        int xc = -1, yc = -1;          // Преобразованные координаты на поле
+        return next_response(false);
+    }
 
+    // Метод wait() — используется после завершения игры для ожидания
+    // действия игрока: выйти или сыграть заново
+    Response wait() const
+    {
         while (true)
         {
-            if (SDL_PollEvent(&windowEvent)) // Ожидаем событие от SDL
-            {
-                switch (windowEvent.type)
-                {
-                case SDL_QUIT:
-                    resp = Response::QUIT; // Пользователь закрыл окно
-                    break;
-                case SDL_MOUSEBUTTONDOWN:
-                    // Получаем координаты нажатия мыши
-                    x = windowEvent.motion.x;
-                    y = windowEvent.motion.y;
-
-                    // Переводим координаты в ячейки поля 8x8
-                    xc = int(y / (board->H / 10) - 1);
-                    yc = int(x / (board->W / 10) - 1);
-
-                    // Проверка: нажата кнопка "Назад"
-                    if (xc == -1 && yc == -1 && board->history_mtx.size() > 1)
-                    {
-                        resp = Response::BACK;
-                    }
-                    // Проверка: нажата кнопка "Сыграть заново"
-                    else if (xc == -1 && yc == 8)
-                    {
-                        resp = Response::REPLAY;
-                    }
-                    // Проверка: клик по игровому полю
-                    else if (xc >= 0 && xc < 8 && yc >= 0 && yc < 8)
-                    {
-                        resp = Response::CELL;
-                    }
-                    // Если клик вне зоны — обнуляем координаты
-                    else
-                    {
-                        xc = -1;
-                        yc = -1;
-                    }
-                    break;
-
-                case SDL_WINDOWEVENT:
-                    // Обработка изменения размеров окна
-                    if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
-                    {
-                        board->reset_window_size();
-                        break;
-                    }
-                }
-
-                // Если получен какой-либо ответ — выходим из цикла
-                if (resp != Response::OK)
-                    break;
-            }
+            const Response resp = get<0>(next_response(true));
+            if (resp != Response::ENGINE)
+                return resp;
         }
-
-        // Возвращаем тип ответа + координаты
-        return { resp, xc, yc };
     }
 
-
-    // Метод wait() — используется после завершения игры для ожидания
-    // действия игрока: выйти или сыграть заново
-    Response wait() const
+    // Ожидание одного события не дольше timeout_ms, пока бот думает или показывает ход.
+    // Возвращает QUIT, REPLAY, BACK или ENGINE; OK — время вышло или событие не требует действий.
+    // Клики по полю в это время не действуют
+    Response wait_event(const int timeout_ms) const
     {
+        board->flush();
         SDL_Event windowEvent;
-        Response resp = Response::OK;
+        if (!SDL_WaitEventTimeout(&windowEvent, timeout_ms))
+            return Response::OK;
+        int xc = -1, yc = -1;
+        const Response resp = dispatch(windowEvent, false, xc, yc);
+        return resp == Response::CELL ? Response::OK : resp;
+    }
 
+private:
+    // Ожидание первого события, которое что-то значит для игры
+    tuple<Response, POS_T, POS_T> next_response(const bool game_over) const
+    {
+        SDL_Event windowEvent;
         while (true)
         {
-            if (SDL_PollEvent(&windowEvent))
-            {
-                switch (windowEvent.type)
-                {
-                case SDL_QUIT:
-                    resp = Response::QUIT;
-                    break;
-
-                case SDL_WINDOWEVENT_SIZE_CHANGED:
-                    board->reset_window_size();
-                    break;
-
-                case SDL_MOUSEBUTTONDOWN: {
-                    int x = windowEvent.motion.x;
-                    int y = windowEvent.motion.y;
-
-                    // Перевод координат мыши в индексы ячеек
-                    int xc = int(y / (board->H / 10) - 1);
-                    int yc = int(x / (board->W / 10) - 1);
-
-                    // Нажата кнопка "Сыграть заново"
-                    if (xc == -1 && yc == 8)
-                        resp = Response::REPLAY;
-                }
-                                        break;
-                }
-
-                if (resp != Response::OK)
-                    break;
-            }
+            board->flush(); // Все изменения поля с прошлого ожидания выводятся одним кадром
+            if (!SDL_WaitEventTimeout(&windowEvent, WAIT_TIMEOUT_MS))
+                continue; // Событий не было — ждём дальше
+
+            int xc = -1, yc = -1;
+            const Response resp = dispatch(windowEvent, game_over, xc, yc);
+            if (resp != Response::OK)
+                return { resp, POS_T(xc), POS_T(yc) };
         }
+    }
+
+    // Единый разбор событий: выход, изменение размера окна, завершение поиска и нажатия мыши.
+    // Response::OK — событие обработано здесь же (или не нужно) и ожидание продолжается
+    Response dispatch(const SDL_Event& windowEvent, const bool game_over, int& xc, int& yc) const
+    {
+        if (windowEvent.type == SDL_QUIT)
+            return Response::QUIT; // Пользователь закрыл окно
 
-        return resp;
+        if (windowEvent.type == SDL_WINDOWEVENT)
+        {
+            // Обработка изменения размеров окна; открывшееся окно рисуется заново
+            if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+                board->reset_window_size();
+            else if (windowEvent.window.event == SDL_WINDOWEVENT_EXPOSED)
+                board->invalidate();
+            return Response::OK;
+        }
+
+        // Содержимое текстур в видеопамяти потеряно — слой фона строится заново
+        if (windowEvent.type == SDL_RENDER_TARGETS_RESET || windowEvent.type == SDL_RENDER_DEVICE_RESET)
+        {
+            board->reset_window_size();
+            return Response::OK;
+        }
+
+        if (windowEvent.type == engine_event())
+            return Response::ENGINE;
+
+        if (windowEvent.type != SDL_MOUSEBUTTONDOWN)
+            return Response::OK;
+
+        // Переводим координаты нажатия мыши в ячейки поля 8x8
+        xc = int(windowEvent.button.y / (board->H / 10) - 1);
+        yc = int(windowEvent.button.x / (board->W / 10) - 1);
+
+        // Проверка: нажата кнопка "Назад" (после окончания партии не действует)
+        if (!game_over && xc == -1 && yc == -1 && state->ply() > 0)
+            return Response::BACK;
+        // Проверка: нажата кнопка "Сыграть заново"
+        if (xc == -1 && yc == 8)
+            return Response::REPLAY;
+        // Проверка: клик по игровому полю
+        if (!game_over && xc >= 0 && xc < 8 && yc >= 0 && yc < 8)
+            return Response::CELL;
+
+        // Если клик вне зоны — обнуляем координаты
+        xc = -1;
+        yc = -1;
+        return Response::OK;
     }
 
+private:
+    static const int WAIT_TIMEOUT_MS = 500; // Наибольшее время одного ожидания события
 
-   private:
     Board* board; // Указатель на игровое поле для взаимодействия (подсветка, размеры и т.д.)
+    const GameState* state; // Состояние партии (наличие ходов для кнопки "Назад")
 };
-
@@ -1,52 +1,310 @@
 ﻿#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <random>
+#include <thread>
 #include <vector>
 #include "../Models/Move.h"
-#include "Board.h"
+#include "../Models/Position.h"
+#include "BatchEval.h"
 #include "Config.h"
+#include "GameState.h"
+#include "MoveGen.h"
+#include "OpeningBook.h"
+#include "SearchStats.h"
+#include "Tablebase.h"
+#include "Trace.h"
+#include "TranspositionTable.h"
 
 const int INF = 1e9;
+const int MAX_PLY = 128;       // Максимальная длина варианта в поиске (в полуходах)
+// Оценки по модулю больше WIN_BOUND — выигрыш или проигрыш с известным числом полуходов до него
+// (по дереву поиска или по эндшпильным таблицам)
+const int WIN_BOUND = WIN_SCORE - 512;
+
+// Состояние поиска одного потока: главные варианты, счётчики, генератор случайных чисел.
+// Позиция и таблица транспозиций общие, всё остальное у каждого потока своё
+struct SearchThread
+{
+    int id = 0;                          // 0 - основной поток, его результат и играется
+    default_random_engine rng;           // Перемешивание ходов корня
+
+    chain_move pv_table[MAX_PLY][MAX_PLY]; // Главные варианты по глубине узла
+    int pv_length[MAX_PLY];              // Длины главных вариантов
+    chain_move root_pv[MAX_PLY];         // Главный вариант последней завершённой итерации
+    int root_pv_length = 0;
+    bool follow_pv = false;              // Текущий узел лежит на главном варианте прошлой итерации
+    bool can_stop = false;               // Разрешена ли остановка (по времени или stop) в текущей итерации
+    undo_info undo_stack[MAX_PLY];       // Данные для отмены хода на каждом полуходе варианта
+    chain_move killers[MAX_PLY][2];      // Тихие ходы, давшие отсечение на этом полуходе (ходы-убийцы)
+    int history[32][32] = {};            // Вес тихих ходов (откуда, куда) по отсечениям в поиске
+    Position children[MAX_TURNS];        // Позиции после тихих ходов узла — для пакетной оценки
+    int child_scores[MAX_TURNS];         // Их оценки с точки зрения соперника
+
+    int completed_depth = 0;             // Глубина последней завершённой итерации
+    int root_score = 0;                  // Оценка корня в последней завершённой итерации
+    SearchStats stats;                   // Счётчики поиска этого потока
+};
 
 class Logic
 {
 public:
-    Logic(Board* board, Config* config) : board(board), config(config)
+    Logic(GameState* state, Config* config)
+        : tt(size_t((*config)("Bot", "HashMB"))), state(state), config(config)
     {
         rand_eng = std::default_random_engine(
             !((*config)("Bot", "NoRandom")) ? unsigned(time(0)) : 0);
 
-        scoring_mode = (*config)("Bot", "BotScoringType");
-        optimization = (*config)("Bot", "Optimization");
+        // Метод оценки позиции: "NumberAndPotential" учитывает и продвижение шашек
+        const string scoring_mode = (*config)("Bot", "BotScoringType");
+        const bool use_potential = scoring_mode == "NumberAndPotential";
+        weights.king = use_potential ? 500 : 400;
+        weights.advance = use_potential ? 5 : 0;
+        const string weights_path = (*config)("Bot", "WeightsPath");
+        if (!weights_path.empty() && !load_weights(project_path + weights_path))
+            log_error("can't load evaluation weights from " + weights_path); // Остаются веса по BotScoringType
+        const string optimization = (*config)("Bot", "Optimization");
+        use_pruning = optimization != "O0";
+        use_ordering = use_pruning;
+        time_limit_ms = (*config)("Bot", "BotTimeMS");
+        quiescence_depth = (*config)("Bot", "QuiescenceDepth");
+        threads = (*config)("Bot", "Threads");
+        if (threads <= 0)
+            threads = max(1, int(thread::hardware_concurrency()));
+        const string tb_path = (*config)("Bot", "TablebasePath");
+        if (!tb_path.empty())
+            tablebase.load(project_path + tb_path); // Без файла бот играет без таблиц
+        const string book_path = (*config)("Bot", "BookPath");
+        if (!book_path.empty())
+            book.load(project_path + book_path);
     }
 
-    // Находит лучший набор ходов с использованием минимакс-алгоритма
-    vector<move_pos> find_best_turns(const bool color)
+    // Поток поиска на время соперника работает с полями объекта: перед уничтожением он останавливается
+    ~Logic()
     {
-        int depth = Max_depth;
-        vector<vector<POS_T>> current = board->get_board();
+        stop_ponder();
+    }
 
-        vector<vector<POS_T>> best_mtx;
-        double best_score = INF;
-        vector<move_pos> best_turns;
+    Logic(const Logic&) = delete;
+    Logic& operator=(const Logic&) = delete;
 
-        find_best_turns_rec(current, color, depth, 0, best_score, best_turns);
+    // Сброс к новой партии: Logic пересоздаётся по текущим настройкам (таблица транспозиций,
+    // история поиска и колбэки тоже сбрасываются)
+    void reset()
+    {
+        stop_ponder();
+        *this = Logic(state, config);
+    }
+
+    // Веса оценки из файла JSON вида {"man": 100, "king": 400, ...} (пишет Tools/texel.cpp);
+    // веса, которых нет в файле, не меняются. false — файл не прочитан или в нём вес не целое число
+    // от -EvalWeights::MAX_WEIGHT до EvalWeights::MAX_WEIGHT; тогда не меняется ни один вес
+    bool load_weights(const string& path)
+    {
+        ifstream fin(path);
+        const json data = json::parse(fin, nullptr, false);
+        if (!data.is_object())
+            return false;
+        EvalWeights loaded = weights;
+        for (int i = 0; i < EvalWeights::COUNT; ++i)
+        {
+            const auto it = data.find(EvalWeights::name(i));
+            if (it == data.end())
+                continue;
+            if (!it->is_number_integer() || abs(it->get<int64_t>()) > EvalWeights::MAX_WEIGHT)
+                return false;
+            loaded[i] = it->get<int>();
+        }
+        weights = loaded;
+        return true;
+    }
 
-        return best_turns;
+    // Переустановка генератора случайных чисел (для воспроизводимых прогонов без доски)
+    void seed(const unsigned value)
+    {
+        rand_eng.seed(value);
     }
 
-    // Находит лучший первый ход (используется, когда не нужно искать всю серию)
-    move_pos find_first_best_turn(const bool color)
+    // Находит лучший ход бота (серия взятий — целиком) поиском negamax с альфа-бета отсечениями
+    chain_move find_best_turn(const bool color)
     {
-        find_turns(color);
-        vector<move_pos> best;
-        double best_score = INF;
+        // Матрица доски упаковывается один раз — дальше поиск работает только с Position
+        return find_best_turn(state->get_position(color));
+    }
 
-        for (const auto& turn : turns)
+    // Поиск из заданной позиции. Основной поток наращивает глубину от 1 до Max_depth + 1,
+    // пока не исчерпан бюджет времени BotTimeMS. Вспомогательные потоки (Lazy SMP) ищут из той же
+    // позиции с другим порядком ходов корня и со сдвигом глубины и делятся результатами только через
+    // общую таблицу транспозиций. Возвращается первый ход главного варианта основного потока
+    chain_move find_best_turn(const Position& current)
+    {
+        TraceScope scope("find_best_turn");
+        // Позиция из дебютной книги разыгрывается без поиска
+        chain_move book_turn;
+        if (book.probe(current, rand_eng, book_turn))
         {
-            vector<vector<POS_T>> mtx = make_turn(board->get_board(), turn);
-            double score = calc_score(mtx, color);
+            stats = SearchStats();
+            completed_depth = 0;
+            best_score = 0;
+            from_book = true;
+            from_ponder = false;
+            return book_turn;
+        }
+        from_book = false;
 
-            if (score < best_score)
+        chain_move ponder_turn;
+        from_ponder = ponder_hit(current, ponder_turn);
+        if (from_ponder)
+            return ponder_turn;
+        return run_search(current, Max_depth + 1, false);
+    }
+
+    // Поиск на время соперника: пока человек думает над ходом в позиции pos, бот ищет из неё
+    // в фоновом потоке на полуход глубже своего уровня. Ответы на все ходы человека попадают в общую
+    // таблицу транспозиций, а если человек сыграет ход главного варианта, готов и ответ на него
+    void start_ponder(const Position& pos)
+    {
+        stop_ponder();
+        ponder_root = pos;
+        has_ponder = true;
+        // Сигнал остановки готовится до запуска потока: stop_ponder(), вызванный сразу после этого, не теряется
+        *stop_search = cancelled->load();
+        ponder_thread = thread([this, depth = Max_depth + 2]() {
+            TraceScope scope("ponder");
+            run_search(ponder_root, depth, true);
+            if (on_search_done)
+                on_search_done();
+        });
+    }
+
+    // Отмена поиска из другого потока: все потоки поиска, в том числе основной на первой итерации,
+    // выходят за несколько узлов, результат поиска не используется. Действует до reset_cancel()
+    void cancel()
+    {
+        *cancelled = true;
+        *stop_search = true;
+    }
+
+    // Снятие отмены перед новым поиском; вызывается потоком, который запускает поиск, до его запуска
+    void reset_cancel()
+    {
+        *cancelled = false;
+        *stop_search = false;
+    }
+
+    bool is_cancelled() const
+    {
+        return *cancelled;
+    }
+
+    // Остановка текущего поиска из другого потока (команда stop): в отличие от cancel() основной поток
+    // возвращает ход последней завершённой итерации. Сигнал действует до конца поиска, а пришедший
+    // между поисками — до reset_stop()
+    void stop()
+    {
+        *stop_search = true;
+    }
+
+    // Снятие сигнала остановки перед новым поиском (отмена сохраняется); вызывается потоком, который
+    // запускает поиск в другом потоке, до его запуска — так stop() сразу после запуска не теряется
+    void reset_stop()
+    {
+        *stop_search = cancelled->load();
+    }
+
+    // Остановка поиска на время соперника; результат последней завершённой итерации сохраняется
+    void stop_ponder()
+    {
+        if (!ponder_thread.joinable())
+            return;
+        *stop_search = true;
+        ponder_thread.join();
+        *stop_search = cancelled->load(); // Сигнал мог прийти, когда поиск уже закончился сам
+    }
+
+private:
+    // Поиск всеми потоками до глубины max_depth; ponder — поиск на время соперника без бюджета времени,
+    // который прерывается только через stop_ponder. Сигнал остановки здесь не сбрасывается: stop() или
+    // cancel(), пришедшие до начала поиска, тоже действуют. После поиска сигнал снимается
+    chain_move run_search(const Position& current, const int max_depth, const bool ponder)
+    {
+        search_start = chrono::steady_clock::now();
+        deadline = ponder || time_limit_ms <= 0 ? chrono::steady_clock::time_point::max()
+                                                : chrono::steady_clock::now() + chrono::milliseconds(time_limit_ms);
+        while (int(search_threads.size()) < threads)
+        {
+            search_threads.push_back(make_unique<SearchThread>());
+            search_threads.back()->id = int(search_threads.size()) - 1;
+        }
+
+        vector<thread> helpers;
+        for (int i = 1; i < threads; ++i)
+        {
+            search_threads[i]->rng.seed(rand_eng() + i);
+            helpers.emplace_back(&Logic::iterative_deepening, this, ref(*search_threads[i]), cref(current), max_depth);
+        }
+        SearchThread& main_thread = *search_threads[0];
+        main_thread.rng.seed(rand_eng());
+        iterative_deepening(main_thread, current, max_depth);
+        *stop_search = true;
+        for (auto& th : helpers)
+            th.join();
+        *stop_search = cancelled->load(); // Сигнал остановил вспомогательные потоки — следующему поиску он не нужен
+        deadline = chrono::steady_clock::time_point::max();
+
+        // Счётчики потоков суммируются, время итераций — по основному потоку
+        stats = main_thread.stats;
+        for (int i = 1; i < threads; ++i)
+            stats += search_threads[i]->stats;
+        stats.time_ms = elapsed_ms();
+        completed_depth = main_thread.completed_depth;
+        best_score = main_thread.root_score;
+
+        return main_thread.root_pv_length ? main_thread.root_pv[0] : chain_move();
+    }
+
+    // Человек сыграл ход, предсказанный поиском на его время, и этот поиск успел просчитать ответ
+    // на полную глубину бота: ответ берётся из главного варианта без нового поиска
+    bool ponder_hit(const Position& current, chain_move& res)
+    {
+        if (!has_ponder)
+            return false;
+        has_ponder = false;
+        const SearchThread& main_thread = *search_threads[0];
+        if (main_thread.root_pv_length < 2 || main_thread.completed_depth - 1 < Max_depth + 1)
+            return false;
+        const Position predicted = make_turn(ponder_root, main_thread.root_pv[0]);
+        if (predicted.hash != current.hash || predicted.white != current.white || predicted.black != current.black ||
+            predicted.kings != current.kings)
+            return false;
+        res = main_thread.root_pv[1];
+        completed_depth = main_thread.completed_depth - 1;
+        best_score = -main_thread.root_score;
+        stats = SearchStats();
+        return true;
+    }
+
+public:
+
+    // Находит лучший ход по оценке позиции после него, без перебора
+    chain_move find_first_best_turn(const bool color)
+    {
+        Position current = state->get_position(color);
+        move_list local_turns;
+        bool have_beats_local;
+        MoveGen::find_turns(current, local_turns, have_beats_local);
+        vector<chain_move> best;
+        int best_score = -INF;
+
+        for (const auto& turn : local_turns)
+        {
+            Position pos = make_turn(current, turn);
+            int score = -calc_score(pos); // Оценка дана с точки зрения соперника
+
+            if (score > best_score)
             {
                 best_score = score;
                 best.clear();
@@ -62,83 +320,469 @@ public:
         return best[0];
     }
 
-    // Рекурсивный минимакс-алгоритм для выбора лучшей последовательности ходов
-    void find_best_turns_rec(
-        vector<vector<POS_T>> mtx,
-        bool color,
-        int depth,
-        int beat_series,
-        double& best_score,
-        vector<move_pos>& best_turns)
+    // Итеративное углубление одного потока до глубины max_depth. Основной поток начинает с глубины 1,
+    // вспомогательные с нечётным номером — на единицу глубже, чтобы потоки расходились по дереву
+    void iterative_deepening(SearchThread& th, const Position& root, const int max_depth)
+    {
+        Position pos = root; // Позиция потока, меняется на месте ходами и их отменой
+        th.stats = SearchStats();
+        th.root_pv_length = 0;
+        th.completed_depth = 0;
+        th.root_score = 0;
+        // Ходы-убийцы относятся к прошлой позиции, а история тихих ходов устаревает постепенно
+        for (int ply = 0; ply < MAX_PLY; ++ply)
+            th.killers[ply][0] = th.killers[ply][1] = chain_move();
+        for (auto& row : th.history)
+            for (auto& value : row)
+                value /= 2;
+        for (int depth = 1 + (th.id & 1); depth <= max_depth; ++depth)
+        {
+            // Первая итерация основного потока всегда доводится до конца, чтобы было что вернуть
+            th.can_stop = th.id == 0 && depth > 1;
+            TraceScope scope("iteration", depth);
+            th.follow_pv = true;
+            const int score = find_best_turns_rec(th, pos, depth, 0, -INF, INF);
+            if (stopped(th))
+                break; // Незавершённая итерация отбрасывается
+
+            th.completed_depth = depth;
+            th.root_score = score;
+            th.root_pv_length = th.pv_length[0];
+            for (int i = 0; i < th.root_pv_length; ++i)
+                th.root_pv[i] = th.pv_table[0][i];
+            SEARCH_STAT(th.stats.depths = min(depth, STATS_MAX_DEPTH));
+            SEARCH_STAT(th.stats.depth_ms[th.stats.depths - 1] = elapsed_ms());
+            if (th.id == 0 && on_iteration)
+                on_iteration(th);
+            if (abs(score) > WIN_BOUND)
+                break; // Исход партии уже просчитан
+        }
+    }
+
+    // Рекурсивный negamax с окном (alpha, beta) и fail-soft границами.
+    // Оценка всегда дана с точки зрения стороны pos.color. Каждый ход — полный ход стороны
+    // (серия взятий целиком), поэтому каждый уровень рекурсии — это полуход.
+    // Главный вариант из узла ply сохраняется в th.pv_table[ply], узлы кешируются в таблице транспозиций.
+    // Позиции из эндшпильных таблиц (кроме корня) не перебираются: их оценка точна.
+    // Ходы делаются и отменяются на месте в pos, поэтому после настройки поиск не выделяет память
+    int find_best_turns_rec(SearchThread& th, Position& pos, const int depth, const int ply, int alpha,
+                            const int beta)
     {
-        if (depth == 0)
+        th.pv_length[ply] = 0;
+        if ((++th.stats.nodes & 1023) == 0 && th.can_stop && chrono::steady_clock::now() >= deadline)
+            *stop_search = true;
+        if (stopped(th))
+            return 0;
+        int tb_value;
+        if (ply > 0 && popcount(pos.occupied()) <= tablebase.max_pieces && tablebase.probe(pos, tb_value))
         {
-            double score = calc_score(mtx, color);
-            if (score < best_score)
+            SEARCH_STAT(++th.stats.tb_hits);
+            return tb_score(tb_value, ply);
+        }
+        if (depth <= 0 || ply >= MAX_PLY - 1)
+            return quiescence(th, pos, ply, alpha, beta, quiescence_depth);
+
+        const bool use_tt = use_pruning;
+        const int alpha_orig = alpha;
+        TTEntry entry;
+        int tt_from = -1, tt_to = -1;
+        if (use_tt && tt.probe(pos.hash, entry, th.stats.tt))
+        {
+            tt_from = entry.from;
+            tt_to = entry.to;
+            if (ply > 0 && entry.depth >= depth)
             {
-                best_score = score;
-                best_turns.clear();
+                const int score = score_from_tt(entry.score, ply);
+                if (entry.bound == Bound::EXACT || (entry.bound == Bound::LOWER && score >= beta) ||
+                    (entry.bound == Bound::UPPER && score <= alpha))
+                    return score;
             }
-            return;
         }
 
-        vector<move_pos> local_turns;
-        bool have_beats_local = false;
+        move_list local_turns;
+        bool have_beats_local;
+        MoveGen::find_turns(pos, local_turns, have_beats_local);
 
-        find_turns(color, mtx);
-        local_turns = turns;
-        have_beats_local = have_beats;
+        if (local_turns.empty())
+            return -(WIN_SCORE - ply); // Ходов нет — проигрыш
 
-        for (const auto& turn : local_turns)
+        if (ply == 0)
+            shuffle(local_turns.begin(), local_turns.end(), th.rng); // Случайный выбор среди равных ходов
+
+        // Пока поиск идёт по главному варианту прошлой итерации, его ход проверяется первым
+        int pv_index = -1;
+        if (th.follow_pv && ply < th.root_pv_length)
         {
-            vector<vector<POS_T>> new_mtx = make_turn(mtx, turn);
-            double local_score = INF;
-            vector<move_pos> local_sequence;
+            const chain_move& pv_turn = th.root_pv[ply];
+            for (int i = 0; i < local_turns.size; ++i)
+            {
+                if (local_turns.moves[i] == pv_turn)
+                {
+                    pv_index = i;
+                    break;
+                }
+            }
+        }
+        th.follow_pv = pv_index != -1;
+
+        int order[MAX_TURNS];
+        score_turns(th, pos, local_turns, order, ply, depth, pv_index, tt_from, tt_to);
 
-            find_best_turns_rec(new_mtx, !color, depth - 1, 0, local_score, local_sequence);
+        int best_score = -INF;
+        int best_from = -1, best_to = -1;
+        for (int i = 0; i < local_turns.size; ++i)
+        {
+            pick_turn(local_turns, order, i);
+            const chain_move& turn = local_turns.moves[i];
+            if (i > 0)
+                th.follow_pv = false;
+            undo_info& undo = th.undo_stack[ply];
+            pos.do_move(turn, undo);
+            const int score = -find_best_turns_rec(th, pos, depth - 1, ply + 1, -beta, -alpha);
+            pos.undo_move(turn, undo);
+            if (stopped(th))
+                return 0;
 
-            if (local_score < best_score)
+            if (score > best_score)
             {
-                best_score = local_score;
-                best_turns.clear();
-                best_turns.push_back(turn);
-                best_turns.insert(best_turns.end(), local_sequence.begin(), local_sequence.end());
+                best_score = score;
+                best_from = turn.from;
+                best_to = turn.to();
+                update_pv(th, ply, turn);
+                if (score > alpha)
+                    alpha = score;
+                if (alpha >= beta && use_pruning)
+                {
+                    // Отсечение: соперник не допустит эту ветку
+                    SEARCH_STAT(++th.stats.cutoffs);
+                    SEARCH_STAT(++th.stats.cutoffs_at[min(i, CUTOFF_SLOTS - 1)]);
+                    if (!turn.captured)
+                        update_quiet_stats(th, turn, ply, depth);
+                    break;
+                }
             }
         }
+
+        if (use_tt)
+        {
+            const Bound bound = best_score <= alpha_orig ? Bound::UPPER
+                                : best_score >= beta     ? Bound::LOWER
+                                                         : Bound::EXACT;
+            tt.store(pos.hash, depth, bound, score_to_tt(best_score, ply), best_from, best_to);
+        }
+        return best_score;
     }
 
+    // Продление поиска в листьях по обязательным взятиям: пока у стороны, чья очередь, есть взятие,
+    // перебираются все серии взятий (тихих ходов в такой позиции нет), иначе позиция оценивается как есть.
+    // Так оценка не берётся посреди размена. Окно (alpha, beta) то же, что у основного поиска;
+    // qdepth ограничивает число полуходов со взятиями, после него позиция оценивается как есть
+    int quiescence(SearchThread& th, Position& pos, const int ply, int alpha, const int beta, const int qdepth)
+    {
+        SEARCH_STAT(th.stats.max_ply = max(th.stats.max_ply, ply));
+        if (qdepth <= 0 || ply >= MAX_PLY - 1 || !MoveGen::has_captures(pos))
+            return leaf_score(th, pos, ply);
+        move_list local_turns;
+        bool have_beats_local;
+        MoveGen::find_turns(pos, local_turns, have_beats_local);
+
+        int order[MAX_TURNS];
+        score_turns(th, pos, local_turns, order, ply, 0, -1, -1, -1);
+        int best_score = -INF;
+        for (int i = 0; i < local_turns.size; ++i)
+        {
+            pick_turn(local_turns, order, i);
+            const chain_move& turn = local_turns.moves[i];
+            undo_info& undo = th.undo_stack[ply];
+            pos.do_move(turn, undo);
+            ++th.stats.nodes;
+            SEARCH_STAT(++th.stats.qnodes);
+            th.pv_length[ply + 1] = 0;
+            const int score = -quiescence(th, pos, ply + 1, -beta, -alpha, qdepth - 1);
+            pos.undo_move(turn, undo);
+            if (score > best_score)
+            {
+                best_score = score;
+                update_pv(th, ply, turn);
+                if (score > alpha)
+                    alpha = score;
+                if (alpha >= beta && use_pruning)
+                    break;
+            }
+        }
+        return best_score;
+    }
+
+    // Первые шаги всех ходов стороны color — игрок вводит ход по шагам
     void find_turns(const bool color)
     {
-        find_turns(color, board->get_board());
+        move_list local_turns;
+        MoveGen::find_turns(state->get_position(color), local_turns, have_beats);
+        set_first_hops(local_turns);
     }
 
+    // Первые шаги ходов фигуры на клетке (x, y), в том числе продолжения начатой серии взятий
     void find_turns(const POS_T x, const POS_T y)
     {
-        find_turns(x, y, board->get_board());
+        const Position pos = state->get_position(0);
+        move_list local_turns;
+        MoveGen::find_turns(square_index(x, y), pos, local_turns, have_beats);
+        set_first_hops(local_turns);
+    }
+
+    // Применяет ход к копии позиции и передаёт очередь хода сопернику
+    Position make_turn(Position pos, const chain_move& turn) const
+    {
+        undo_info undo;
+        pos.do_move(turn, undo);
+        return pos;
     }
 
 public:
-    vector<move_pos> turns; // Список возможных ходов
+    vector<move_pos> turns; // Первые шаги возможных ходов (для ввода игрока)
     bool have_beats;        // Наличие взятий
-    int Max_depth;          // Глубина поиска для ИИ
+    int Max_depth;          // Наибольшая глубина поиска для ИИ
+    int time_limit_ms;      // Бюджет времени на ход в миллисекундах (0 - без ограничения)
+    int threads;            // Число потоков поиска
+    TranspositionTable tt;  // Таблица транспозиций (живёт между ходами одной партии, общая для потоков)
+    Tablebase tablebase;    // Эндшпильные таблицы (Bot.TablebasePath), только чтение — общие для потоков
+    OpeningBook book;       // Дебютная книга (Bot.BookPath)
+
+    // Итоги последнего поиска по всем потокам
+    SearchStats stats;       // Счётчики поиска (без поиска — ход из книги или ответ из поиска на время соперника — нули)
+    int completed_depth = 0; // Глубина последней завершённой итерации основного потока
+    int best_score = 0;      // Оценка лучшего хода с точки зрения стороны, чья очередь хода
+    bool from_book = false;  // Ход взят из дебютной книги без поиска
+    bool from_ponder = false; // Ход взят из поиска на время соперника
+    function<void()> on_search_done; // Вызывается из потока фонового поиска по его завершении
+    // Вызывается из основного потока поиска после каждой завершённой итерации углубления
+    function<void(const SearchThread&)> on_iteration;
+    bool use_ordering;               // Упорядочивание ходов (взятия, ходы-убийцы, история)
+    bool incremental_eval = true;    // Оценка по слагаемым позиции (false — пересчёт по доске в каждом листе)
+    // Порядок тихих ходов с учётом пакетной оценки дочерних позиций. Выключен: при нынешних весах
+    // любой тихий ход шашки продвигает её ровно на ряд, и оценки дочерних позиций совпадают
+    bool eval_ordering = false;
+    EvalWeights weights;             // Веса оценки (по Bot.BotScoringType или из файла Bot.WeightsPath)
+    int quiescence_depth;            // Наибольшее число полуходов продления по взятиям (Bot.QuiescenceDepth)
+
+    // Оценка позиции с точки зрения стороны pos.color: разность сил в сотых долях шашки.
+    // Слагаемые берутся из pos.eval, которые ходы обновляют по разнице, — оценка листа не обходит доску.
+    // При сборке с CHECKERS_CHECK_EVAL каждое значение сверяется с полным пересчётом
+    int calc_score(const Position& pos) const
+    {
+        const uint32_t own = pos.pieces(pos.color), enemy = pos.pieces(!pos.color);
+        if (!own)
+            return -WIN_SCORE;
+        if (!enemy)
+            return WIN_SCORE;
+
+#ifdef CHECKERS_CHECK_EVAL
+        if (!(pos.eval == pos.calc_eval()))
+            throw runtime_error("incremental evaluation differs from full recompute in " + pos.to_fen());
+#endif
+        const EvalTerms terms = incremental_eval ? pos.eval : pos.calc_eval();
+        // Продвинутые шашки ближе к превращению в дамку (вес advance ненулевой при "NumberAndPotential")
+        const int w = weights.man * terms.men[0] + weights.king * terms.kings[0] + weights.advance * terms.advance[0];
+        const int b = weights.man * terms.men[1] + weights.king * terms.kings[1] + weights.advance * terms.advance[1];
+        // Центр, первый ряд и подвижность не входят в слагаемые позиции и считаются по маскам
+        const int diff = w - b + (weights.has_positional() ? BatchEval::positional(pos, weights) : 0);
+        return pos.color ? -diff : diff;
+    }
 
 private:
-    vector<vector<POS_T>> make_turn(vector<vector<POS_T>> mtx, move_pos turn) const;
+    // Статическая оценка листа ply. Потеря всех фигур, как и отсутствие ходов,
+    // тем хуже, чем раньше она наступает
+    int leaf_score([[maybe_unused]] SearchThread& th, const Position& pos, const int ply) const
+    {
+        SEARCH_STAT(++th.stats.evals);
+        const int score = calc_score(pos);
+        return abs(score) == WIN_SCORE ? (score > 0 ? score - ply : score + ply) : score;
+    }
+
+    // Оценка узла ply по байту эндшпильных таблиц: d полуходов до конца партии,
+    // при нечётном d сторона, чья очередь, выигрывает
+    static int tb_score(const int value, const int ply)
+    {
+        if (!value)
+            return 0; // Ничья
+        const int d = value - 1;
+        return d % 2 ? WIN_SCORE - (ply + d) : -(WIN_SCORE - (ply + d));
+    }
+
+    // Пора ли потоку th прервать поиск: по сигналу остановки (основной поток — только если ему разрешено
+    // остановиться в этой итерации) или по отмене
+    bool stopped(const SearchThread& th) const
+    {
+        return *stop_search && (th.id != 0 || th.can_stop || *cancelled);
+    }
+
+    // Запись ошибки настроек в log.txt (как у Board)
+    static void log_error(const string& text)
+    {
+        ofstream fout(project_path + "log.txt", ios_base::app);
+        fout << "Error: " << text << "." << endl;
+    }
+
+    // Время от начала текущего поиска
+    double elapsed_ms() const
+    {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - search_start).count();
+    }
 
-    double calc_score(const vector<vector<POS_T>>& mtx, const bool first_bot_color) const;
+    // Оценки выигрыша хранятся в таблице относительно узла, а не корня поиска
+    static int score_to_tt(const int score, const int ply)
+    {
+        if (score > WIN_BOUND)
+            return score + ply;
+        if (score < -WIN_BOUND)
+            return score - ply;
+        return score;
+    }
+
+    static int score_from_tt(const int score, const int ply)
+    {
+        if (score > WIN_BOUND)
+            return score - ply;
+        if (score < -WIN_BOUND)
+            return score + ply;
+        return score;
+    }
+
+    // Оценки порядка ходов: ход главного варианта, ход из таблицы транспозиций, взятия и превращения,
+    // ходы-убийцы, остальные тихие ходы по истории отсечений
+    static const int ORDER_PV = 1 << 30;
+    static const int ORDER_TT = 1 << 29;
+    static const int ORDER_CAPTURE = 1 << 28;
+    static const int ORDER_KILLER = 1 << 27;
+    static const int HISTORY_MAX = 1 << 26;
+    static const int EVAL_ORDER_DEPTH = 3; // Тихие ходы узлов от этой глубины упорядочиваются и по оценке
+
+
+    // Оценивает каждый ход узла для порядка перебора; при выключенном упорядочивании
+    // остаются только ход главного варианта и ход из таблицы, остальные идут в порядке генерации.
+    // В узлах не ниже EVAL_ORDER_DEPTH позиции после тихих ходов оцениваются одним пакетом (BatchEval),
+    // и оценка добавляется к весу истории: без истории первыми идут ходы с лучшей оценкой
+    void score_turns(SearchThread& th, const Position& pos, const move_list& turns, int* order, const int ply,
+                     const int depth, const int pv_index, const int tt_from, const int tt_to) const
+    {
+        int quiet[MAX_TURNS];
+        int quiet_count = 0;
+        for (int i = 0; i < turns.size; ++i)
+        {
+            const chain_move& turn = turns.moves[i];
+            const int from = turn.from, to = turn.to();
+            int score = 0;
+            if (i == pv_index)
+                score = ORDER_PV;
+            else if (from == tt_from && to == tt_to)
+                score = ORDER_TT;
+            else if (use_ordering)
+            {
+                if (turn.captured)
+                {
+                    // Сначала серии, берущие больше материала, с превращением в дамку — выше
+                    score = ORDER_CAPTURE + 100 * popcount(turn.captured) + 300 * popcount(turn.captured & pos.kings) +
+                            (turn.promotes ? 300 : 0);
+                }
+                else if (turn.promotes)
+                    score = ORDER_CAPTURE;
+                else if (turn == th.killers[ply][0])
+                    score = ORDER_KILLER + 1;
+                else if (turn == th.killers[ply][1])
+                    score = ORDER_KILLER;
+                else
+                {
+                    score = th.history[from][to];
+                    quiet[quiet_count++] = i;
+                }
+            }
+            order[i] = score;
+        }
+
+        if (!eval_ordering || depth < EVAL_ORDER_DEPTH || quiet_count < 2)
+            return;
+        for (int k = 0; k < quiet_count; ++k)
+            th.children[k] = make_turn(pos, turns.moves[quiet[k]]);
+        BatchEval::evaluate(th.children, quiet_count, weights, th.child_scores);
+        for (int k = 0; k < quiet_count; ++k)
+            order[quiet[k]] -= th.child_scores[k]; // Тихий ход не берёт фигур, так что оценка ограничена
+    }
+
+    // Ставит на место i лучший из ещё не просмотренных ходов. Ходы выбираются по одному,
+    // поэтому после раннего отсечения остаток списка не сортируется
+    static void pick_turn(move_list& turns, int* order, const int i)
+    {
+        int best = i;
+        for (int j = i + 1; j < turns.size; ++j)
+        {
+            if (order[j] > order[best])
+                best = j;
+        }
+        if (best != i)
+        {
+            swap(turns.moves[i], turns.moves[best]);
+            swap(order[i], order[best]);
+        }
+    }
 
-    void find_turns(const bool color, const vector<vector<POS_T>>& mtx);
+    // Тихий ход дал отсечение: он становится ходом-убийцей этого шага и набирает вес в истории
+    static void update_quiet_stats(SearchThread& th, const chain_move& turn, const int ply, const int depth)
+    {
+        if (turn != th.killers[ply][0])
+        {
+            th.killers[ply][1] = th.killers[ply][0];
+            th.killers[ply][0] = turn;
+        }
+        int& value = th.history[turn.from][turn.to()];
+        value += depth * depth;
+        if (value >= HISTORY_MAX)
+        {
+            for (auto& row : th.history)
+                for (auto& v : row)
+                    v /= 2;
+        }
+    }
 
-    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>>& mtx);
+    // Различные первые шаги ходов списка — в turns
+    void set_first_hops(const move_list& local_turns)
+    {
+        turns.clear();
+        for (const auto& turn : local_turns)
+        {
+            const move_pos hop = chain_hops(turn)[0];
+            if (find(turns.begin(), turns.end(), hop) == turns.end())
+                turns.push_back(hop);
+        }
+    }
+
+    // Главный вариант узла ply: ход turn и главный вариант дочернего узла
+    static void update_pv(SearchThread& th, const int ply, const chain_move& turn)
+    {
+        th.pv_table[ply][0] = turn;
+        for (int i = 0; i < th.pv_length[ply + 1]; ++i)
+            th.pv_table[ply][i + 1] = th.pv_table[ply + 1][i];
+        th.pv_length[ply] = th.pv_length[ply + 1] + 1;
+    }
 
 private:
+    // Перенос — только в reset(), когда поиск на время соперника уже остановлен
+    Logic(Logic&&) = default;
+    Logic& operator=(Logic&&) = default;
+
     default_random_engine rand_eng; // Генератор случайных чисел
-    string scoring_mode;            // Метод оценки позиции
-    string optimization;            // Режим оптимизации
+    bool use_pruning;               // Альфа-бета отсечения (выключены при "O0")
 
-    vector<move_pos> next_move;     // Следующий ход для ИИ
-    vector<int> next_best_state;    // Состояния для анализа
+    vector<unique_ptr<SearchThread>> search_threads; // Состояния потоков поиска (создаются по требованию)
+    // Момент, когда поиск должен остановиться; вне run_search срока нет (итеративное углубление напрямую)
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::time_point::max();
+    chrono::steady_clock::time_point search_start;   // Начало поиска (для времени итераций)
+    thread ponder_thread;                            // Поток поиска на время соперника
+    Position ponder_root;                            // Позиция, из которой он ищет
+    bool has_ponder = false;                         // Его результат ещё не проверен на совпадение хода
+    // Сигнал остановки для всех потоков; в куче, чтобы Logic оставался перемещаемым
+    unique_ptr<atomic<bool>> stop_search = make_unique<atomic<bool>>(false);
+    unique_ptr<atomic<bool>> cancelled = make_unique<atomic<bool>>(false); // Поиск отменён (cancel)
 
-    Board* board;                   // Указатель на доску
+    GameState* state;               // Указатель на состояние партии
     Config* config;                 // Указатель на настройки
 };
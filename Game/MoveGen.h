@@ -0,0 +1,148 @@
+﻿// Генератор ходов по упакованной позиции. Не зависит от графики и настроек,
+// поэтому используется и ботом, и консольными инструментами (perft и др.)
+#pragma once
+#include "../Models/Move.h"
+#include "../Models/Position.h"
+
+class MoveGen
+{
+public:
+    // Все ходы стороны pos.color; при наличии взятий остаются только взятия.
+    // Серия взятий выдаётся одним ходом целиком, серии с одинаковым результатом — один раз
+    static void find_turns(const Position& pos, move_list& res_turns, bool& beats)
+    {
+        res_turns.clear();
+        const uint32_t own = pos.pieces(pos.color);
+        for (uint32_t m = own; m; m &= m - 1)
+            add_captures(lsb(m), pos, res_turns);
+        beats = !res_turns.empty();
+        if (beats)
+            return;
+        for (uint32_t m = own; m; m &= m - 1)
+            add_quiet(lsb(m), pos, res_turns);
+    }
+
+    // Ходы фигуры на клетке sq; при наличии взятий возвращаются только серии взятий
+    static void find_turns(const int sq, const Position& pos, move_list& res_turns, bool& beats)
+    {
+        res_turns.clear();
+        beats = false;
+        if (sq == -1 || !(pos.occupied() >> sq & 1))
+            return;
+        add_captures(sq, pos, res_turns);
+        beats = !res_turns.empty();
+        if (!beats)
+            add_quiet(sq, pos, res_turns);
+    }
+
+    // Есть ли у стороны pos.color хотя бы одно взятие — без построения серий
+    static bool has_captures(const Position& pos)
+    {
+        const uint32_t enemy = pos.pieces(!pos.color), empty = ~pos.occupied();
+        for (uint32_t m = pos.pieces(pos.color); m; m &= m - 1)
+        {
+            const int sq = lsb(m);
+            const bool is_king = pos.kings >> sq & 1;
+            for (int dir = 0; dir < 4; ++dir)
+            {
+                int t = square_steps.step[sq][dir];
+                if (is_king)
+                {
+                    while (t != -1 && (empty >> t & 1))
+                        t = square_steps.step[t][dir];
+                }
+                if (t == -1 || !(enemy >> t & 1))
+                    continue;
+                const int land = square_steps.step[t][dir];
+                if (land != -1 && (empty >> land & 1))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    // Все серии взятий фигуры на клетке sq
+    static void add_captures(const int sq, const Position& pos, move_list& res_turns)
+    {
+        const uint32_t bit = 1u << sq;
+        const bool is_white = pos.white & bit;
+        chain_move turn;
+        turn.from = int8_t(sq);
+        // Клетка, с которой фигура начала ход, освобождается: дамка может пройти через неё
+        extend_chain(sq, pos.kings & bit, is_white, is_white ? pos.black : pos.white, ~pos.occupied() | bit, turn,
+                     res_turns);
+    }
+
+    // Продолжение серии turn с клетки sq. Побитые фигуры снимаются сразу, их клетки становятся свободными.
+    // Шашка, дошедшая до последнего ряда, продолжает серию дамкой. Серия записывается, когда бить больше нечего
+    static void extend_chain(const int sq, const bool is_king, const bool is_white, const uint32_t enemy,
+                             const uint32_t empty, chain_move& turn, move_list& res_turns)
+    {
+        bool extended = false;
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            int t = square_steps.step[sq][dir];
+            if (is_king)
+            {
+                while (t != -1 && (empty >> t & 1))
+                    t = square_steps.step[t][dir];
+            }
+            if (t == -1 || !(enemy >> t & 1))
+                continue;
+            const uint32_t beat_bit = 1u << t;
+            for (int land = square_steps.step[t][dir]; land != -1 && (empty >> land & 1);
+                 land = square_steps.step[land][dir])
+            {
+                extended = true;
+                const bool promotes = !is_king && square_x(land) == (is_white ? 0 : 7);
+                const bool promoted_before = turn.promotes;
+                turn.path[turn.length++] = int8_t(land);
+                turn.captured |= beat_bit;
+                turn.promotes = promoted_before || promotes;
+                extend_chain(land, is_king || promotes, is_white, enemy & ~beat_bit, empty | beat_bit, turn,
+                             res_turns);
+                turn.promotes = promoted_before;
+                turn.captured &= ~beat_bit;
+                --turn.length;
+                if (!is_king)
+                    break;
+            }
+        }
+        if (extended || turn.length == 0)
+            return;
+
+        // Дамка может побить те же фигуры в другом порядке и прийти на ту же клетку — это один ход
+        for (const auto& other : res_turns)
+        {
+            if (other == turn)
+                return;
+        }
+        res_turns.push_back(turn);
+    }
+
+    // Тихие ходы фигуры на клетке sq: шашки — только вперёд, дамки — на любое расстояние
+    static void add_quiet(const int sq, const Position& pos, move_list& res_turns)
+    {
+        const uint32_t bit = 1u << sq;
+        const bool is_white = pos.white & bit;
+        const bool is_king = pos.kings & bit;
+        const uint32_t empty = ~pos.occupied();
+        chain_move turn;
+        turn.from = int8_t(sq);
+        turn.length = 1;
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            if (!is_king && (dir < 2) != is_white)
+                continue;
+            for (int t = square_steps.step[sq][dir]; t != -1 && (empty >> t & 1); t = square_steps.step[t][dir])
+            {
+                turn.path[0] = int8_t(t);
+                turn.promotes = !is_king && square_x(t) == (is_white ? 0 : 7);
+                res_turns.push_back(turn);
+                if (!is_king)
+                    break;
+            }
+        }
+    }
+};
@@ -0,0 +1,117 @@
+﻿// Дебютная книга: для позиций начала партии — заранее посчитанные хорошие ходы с весами.
+// Файл строит Tools/bookgen.cpp. Записи отсортированы по Zobrist-хешу позиции, файл отображается
+// в память и ищется двоичным поиском прямо в отображении, поэтому загрузка не зависит от размера книги
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <stdint.h>
+#include <string>
+
+#include "../Models/Position.h"
+#include "MappedFile.h"
+#include "MoveGen.h"
+
+using namespace std;
+
+// Заголовок файла книги, за ним — count записей BookEntry по возрастанию key
+struct BookHeader
+{
+    char magic[4];  // "CKBK"
+    uint32_t version;
+    uint64_t count; // Число записей
+};
+
+// Ход книги. Ход позиции определяется клетками начала и конца и маской побитых фигур
+struct BookEntry
+{
+    uint64_t key;      // Zobrist-хеш позиции (с учётом очереди хода)
+    uint32_t captured; // Маска побитых фигур
+    uint8_t from, to;  // Клетки 0..31
+    uint16_t weight;   // Вес хода при случайном выборе
+};
+
+const char BOOK_MAGIC[4] = { 'C', 'K', 'B', 'K' };
+const uint32_t BOOK_VERSION = 1;
+
+class OpeningBook
+{
+public:
+    // Загрузка книги; при ошибке книга остаётся пустой
+    bool load(const string& path)
+    {
+        entries = nullptr;
+        count = 0;
+        if (!file.open(path) || file.size < sizeof(BookHeader))
+            return false;
+        BookHeader header;
+        memcpy(&header, file.data, sizeof(header));
+        if (memcmp(header.magic, BOOK_MAGIC, 4) != 0 || header.version != BOOK_VERSION ||
+            file.size < sizeof(BookHeader) + header.count * sizeof(BookEntry))
+        {
+            file.close();
+            return false;
+        }
+        entries = reinterpret_cast<const BookEntry*>(file.data + sizeof(BookHeader));
+        count = size_t(header.count);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    // Случайный по весам ход книги для позиции pos; false, если позиции в книге нет.
+    // Записи сверяются с ходами позиции, так что случайное совпадение хешей не даст невозможный ход
+    bool probe(const Position& pos, default_random_engine& rng, chain_move& res) const
+    {
+        if (!count)
+            return false;
+        const BookEntry* end = entries + count;
+        const BookEntry* first = lower_bound(entries, end, pos.hash,
+                                             [](const BookEntry& e, const uint64_t key) { return e.key < key; });
+        if (first == end || first->key != pos.hash)
+            return false;
+
+        move_list turns;
+        bool beats;
+        MoveGen::find_turns(pos, turns, beats);
+        chain_move candidates[MAX_TURNS];
+        uint32_t weights[MAX_TURNS];
+        int size = 0;
+        uint32_t total = 0;
+        for (const BookEntry* e = first; e != end && e->key == pos.hash && size < MAX_TURNS; ++e)
+        {
+            for (const auto& turn : turns)
+            {
+                if (turn.from == e->from && turn.to() == e->to && turn.captured == e->captured)
+                {
+                    candidates[size] = turn;
+                    weights[size++] = e->weight;
+                    total += e->weight;
+                    break;
+                }
+            }
+        }
+        if (!total)
+            return false;
+
+        uint32_t pick = uniform_int_distribution<uint32_t>(0, total - 1)(rng);
+        for (int i = 0; i < size; ++i)
+        {
+            if (pick < weights[i])
+            {
+                res = candidates[i];
+                return true;
+            }
+            pick -= weights[i];
+        }
+        return false;
+    }
+
+private:
+    MappedFile file;
+    const BookEntry* entries = nullptr; // Записи прямо в отображённом файле
+    size_t count = 0;
+};
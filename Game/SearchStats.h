@@ -0,0 +1,56 @@
+﻿// Счётчики поиска: каждый поток ведёт свои в SearchThread без блокировок, после поиска они суммируются в Logic.
+// При сборке с CHECKERS_NO_STATS остаются только узлы и обращения к таблице транспозиций (нужны самому поиску
+// и его настройке), остальные счётчики и журнал StatsLog исчезают из кода
+#pragma once
+#include <algorithm>
+#include <stdint.h>
+
+#include "TranspositionTable.h" // Счётчики обращений к таблице
+
+using namespace std;
+
+#ifdef CHECKERS_NO_STATS
+    #define SEARCH_STAT(expr) ((void)0)
+#else
+    #define SEARCH_STAT(expr) (expr)
+#endif
+
+const int CUTOFF_SLOTS = 8;       // Отсечения по номеру хода узла: 1-й, 2-й, ..., 8-й и дальше
+const int STATS_MAX_DEPTH = 128;  // Наибольшая глубина итерации с замером времени
+
+struct SearchStats
+{
+    uint64_t nodes = 0;                     // Число просмотренных узлов
+    uint64_t qnodes = 0;                    // Из них — узлы продления по взятиям
+    uint64_t evals = 0;                     // Оценки листьев
+    uint64_t tb_hits = 0;                   // Узлы, оценённые по эндшпильным таблицам
+    TTStats tt;                             // Обращения к таблице транспозиций
+    uint64_t cutoffs = 0;                   // Число отсечений по beta
+    uint64_t cutoffs_at[CUTOFF_SLOTS] = {}; // Из них — на i-м ходе узла (последний — на 8-м и дальше)
+    int max_ply = 0;                        // Наибольшая глубина узла с продлениями (селективная глубина)
+    double time_ms = 0;                     // Время поиска
+    // Время от начала поиска до конца итерации глубины d — только у основного потока
+    double depth_ms[STATS_MAX_DEPTH] = {};
+    int depths = 0;                         // Число записанных итераций (глубины 1..depths)
+
+    // Отсечения на первом ходе узла — мера качества порядка ходов
+    uint64_t first_move_cutoffs() const
+    {
+        return cutoffs_at[0];
+    }
+
+    // Суммирование счётчиков другого потока (время итераций не суммируется)
+    SearchStats& operator+=(const SearchStats& other)
+    {
+        nodes += other.nodes;
+        qnodes += other.qnodes;
+        evals += other.evals;
+        tb_hits += other.tb_hits;
+        tt += other.tt;
+        cutoffs += other.cutoffs;
+        for (int i = 0; i < CUTOFF_SLOTS; ++i)
+            cutoffs_at[i] += other.cutoffs_at[i];
+        max_ply = max(max_ply, other.max_ply);
+        return *this;
+    }
+};
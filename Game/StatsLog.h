@@ -0,0 +1,92 @@
+﻿// Журнал статистики в формате JSON lines: одна запись (объект JSON) на строку.
+// Записи копятся в памяти и пишутся в файл блоками, файл открыт всё время работы журнала.
+// При сборке с CHECKERS_NO_STATS журнал ничего не делает и файл не создаётся
+#pragma once
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include "Config.h"      // json
+#include "SearchStats.h" // Счётчики поиска
+
+using namespace std;
+
+class StatsLog
+{
+public:
+    // Журнал в файле path; прошлое содержимое файла стирается
+    explicit StatsLog([[maybe_unused]] const string& path)
+    {
+#ifndef CHECKERS_NO_STATS
+        fout.open(path, ios_base::trunc);
+        buffer.reserve(BUFFER_SIZE);
+#endif
+    }
+
+    ~StatsLog()
+    {
+        flush();
+    }
+
+    // Запись в буфер; в файл она попадает, когда буфер заполнится, или при flush()
+    void write([[maybe_unused]] const json& record)
+    {
+#ifndef CHECKERS_NO_STATS
+        lock_guard<mutex> lock(mtx);
+        buffer += record.dump();
+        buffer += '\n';
+        if (buffer.size() >= BUFFER_SIZE)
+            write_buffer();
+#endif
+    }
+
+    void flush()
+    {
+#ifndef CHECKERS_NO_STATS
+        lock_guard<mutex> lock(mtx);
+        write_buffer();
+        fout.flush();
+#endif
+    }
+
+    // Запись о поиске: счётчики, скорость и время каждой итерации углубления
+    static json search_record([[maybe_unused]] const SearchStats& stats)
+    {
+        json res;
+#ifndef CHECKERS_NO_STATS
+        res["nodes"] = stats.nodes;
+        res["nps"] = uint64_t(stats.nodes * 1000 / max(stats.time_ms, 1e-3));
+        res["search_ms"] = stats.time_ms;
+        res["qnodes"] = stats.qnodes;
+        res["evals"] = stats.evals;
+        res["tt_probes"] = stats.tt.hits + stats.tt.misses + stats.tt.collisions;
+        res["tt_hits"] = stats.tt.hits;
+        res["tt_collisions"] = stats.tt.collisions;
+        res["tb_hits"] = stats.tb_hits;
+        res["cutoffs"] = stats.cutoffs;
+        res["cutoffs_at"] = json::array();
+        for (int i = 0; i < CUTOFF_SLOTS; ++i)
+            res["cutoffs_at"].push_back(stats.cutoffs_at[i]);
+        res["max_ply"] = stats.max_ply;
+        res["depth_ms"] = json::array();
+        for (int d = 0; d < stats.depths; ++d)
+            res["depth_ms"].push_back(stats.depth_ms[d]);
+#endif
+        return res;
+    }
+
+private:
+#ifndef CHECKERS_NO_STATS
+    void write_buffer()
+    {
+        fout.write(buffer.data(), streamsize(buffer.size()));
+        buffer.clear();
+    }
+
+    static const size_t BUFFER_SIZE = 64 * 1024; // Размер блока записи в файл
+
+    ofstream fout;
+    string buffer; // Записи, ещё не записанные в файл
+    mutex mtx;     // Журнал общий для потоков
+#endif
+};
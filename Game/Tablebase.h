@@ -0,0 +1,268 @@
+﻿// Эндшпильные таблицы: для каждой позиции с небольшим числом фигур хранится исход при лучшей игре
+// и число полуходов до конца партии. Файл строит Tools/tbgen.cpp, движок отображает его в память
+// и читает прямо из отображения — без копирования и без блокировок.
+// Позиции хранятся только с ходом белых: позиция с ходом чёрных переворачивается (см. flip_position)
+#pragma once
+#include <cstring>
+#include <stdint.h>
+#include <string>
+
+#include "../Models/Position.h"
+#include "MappedFile.h"
+
+using namespace std;
+
+const int TB_MAX_PIECES = 6; // Наибольшее число фигур в таблицах
+
+// Клетки, на которых может стоять шашка: белая шашка на первом ряду (клетки 0..3) уже стала бы дамкой,
+// чёрная — на последнем (28..31)
+const uint32_t TB_WHITE_MEN_SQUARES = 0xFFFFFFF0u;
+const uint32_t TB_BLACK_MEN_SQUARES = 0x0FFFFFFFu;
+
+// Состав фигур — одна таблица (срез): белые шашки и дамки, чёрные шашки и дамки
+struct Material
+{
+    int wm = 0, wk = 0, bm = 0, bk = 0;
+
+    int pieces() const
+    {
+        return wm + wk + bm + bk;
+    }
+
+    // Состав после переворота доски со сменой цветов
+    Material flipped() const
+    {
+        return Material{ bm, bk, wm, wk };
+    }
+
+    bool operator==(const Material& other) const
+    {
+        return wm == other.wm && wk == other.wk && bm == other.bm && bk == other.bk;
+    }
+};
+
+// Заголовок файла таблиц, за ним — slice_count описаний срезов TBSlice, затем данные срезов.
+// Каждая позиция — один байт: 0 — ничья (или позиция невозможна), иначе d + 1, где d — число
+// полуходов до конца партии; при нечётном d сторона, чья очередь, выигрывает, при чётном — проигрывает
+struct TBHeader
+{
+    char magic[4];        // "CKTB"
+    uint32_t version;     // Версия формата
+    uint32_t max_pieces;  // Наибольшее число фигур
+    uint32_t slice_count; // Число срезов
+};
+
+struct TBSlice
+{
+    uint8_t wm, wk, bm, bk; // Состав фигур
+    uint32_t reserved;
+    uint64_t offset;        // Смещение данных среза от начала файла
+    uint64_t size;          // Число позиций (байтов) среза
+};
+
+const char TB_MAGIC[4] = { 'C', 'K', 'T', 'B' };
+const uint32_t TB_VERSION = 1;
+
+// Биномиальные коэффициенты C(n, k) для n, k до 32
+struct Binomials
+{
+    uint64_t c[33][33];
+
+    Binomials()
+    {
+        for (int n = 0; n <= 32; ++n)
+        {
+            c[n][0] = 1;
+            for (int k = 1; k <= 32; ++k)
+                c[n][k] = n ? c[n - 1][k - 1] + c[n - 1][k] : 0;
+        }
+    }
+};
+
+inline const Binomials binomials;
+
+// Зеркальное отражение маски: поворот доски на 180 градусов переводит клетку sq в 31 - sq
+inline uint32_t reverse_bits(uint32_t mask)
+{
+    mask = (mask >> 1 & 0x55555555u) | (mask & 0x55555555u) << 1;
+    mask = (mask >> 2 & 0x33333333u) | (mask & 0x33333333u) << 2;
+    mask = (mask >> 4 & 0x0F0F0F0Fu) | (mask & 0x0F0F0F0Fu) << 4;
+    mask = (mask >> 8 & 0x00FF00FFu) | (mask & 0x00FF00FFu) << 8;
+    return mask >> 16 | mask << 16;
+}
+
+// Поворот доски со сменой цветов: чёрные становятся белыми и ходят вверх, очередь хода меняется.
+// Хеш не пересчитывается — перевёрнутая позиция нужна только для обращения к таблицам
+inline Position flip_position(const Position& pos)
+{
+    Position res;
+    res.white = reverse_bits(pos.black);
+    res.black = reverse_bits(pos.white);
+    res.kings = reverse_bits(pos.kings);
+    res.color = !pos.color;
+    return res;
+}
+
+inline Material material_of(const Position& pos)
+{
+    Material m;
+    m.wm = popcount(pos.white & ~pos.kings);
+    m.wk = popcount(pos.white & pos.kings);
+    m.bm = popcount(pos.black & ~pos.kings);
+    m.bk = popcount(pos.black & pos.kings);
+    return m;
+}
+
+// Нумерация позиций одного среза. Фигуры расставляются по очереди: белые шашки среди своих 28 клеток,
+// чёрные шашки среди своих 28 клеток, белые дамки среди клеток, свободных от шашек, чёрные дамки среди
+// оставшихся. Номер набора клеток внутри допустимых — комбинаторная нумерация (сумма C(p_i, i + 1)).
+// Номера, где белые и чёрные шашки попали на одну клетку, не соответствуют позициям и пропускаются
+class TBIndex
+{
+public:
+    static uint64_t slice_size(const Material& m)
+    {
+        const int free_kings = 32 - m.wm - m.bm;
+        return binomials.c[28][m.wm] * binomials.c[28][m.bm] * binomials.c[free_kings][m.wk] *
+               binomials.c[free_kings - m.wk][m.bk];
+    }
+
+    // Номер позиции с ходом белых внутри её среза
+    static uint64_t index(const Position& pos)
+    {
+        const uint32_t wm = pos.white & ~pos.kings, bm = pos.black & ~pos.kings;
+        const uint32_t wk = pos.white & pos.kings, bk = pos.black & pos.kings;
+        const uint32_t free_kings = ~(wm | bm);
+        const int n_wm = popcount(wm), n_bm = popcount(bm), n_wk = popcount(wk), n_bk = popcount(bk);
+        uint64_t res = rank(wm, TB_WHITE_MEN_SQUARES);
+        res = res * binomials.c[28][n_bm] + rank(bm, TB_BLACK_MEN_SQUARES);
+        res = res * binomials.c[32 - n_wm - n_bm][n_wk] + rank(wk, free_kings);
+        res = res * binomials.c[32 - n_wm - n_bm - n_wk][n_bk] + rank(bk, free_kings & ~wk);
+        return res;
+    }
+
+    // Позиция с ходом белых по номеру; false, если номер не соответствует позиции
+    static bool position(const Material& m, uint64_t idx, Position& pos)
+    {
+        const int free_kings = 32 - m.wm - m.bm;
+        const uint64_t n_bk = binomials.c[free_kings - m.wk][m.bk], n_wk = binomials.c[free_kings][m.wk];
+        const uint64_t n_bm = binomials.c[28][m.bm];
+        const uint64_t r_bk = idx % n_bk;
+        idx /= n_bk;
+        const uint64_t r_wk = idx % n_wk;
+        idx /= n_wk;
+        const uint64_t r_bm = idx % n_bm;
+        const uint64_t r_wm = idx / n_bm;
+
+        const uint32_t wm = unrank(r_wm, m.wm, TB_WHITE_MEN_SQUARES);
+        const uint32_t bm = unrank(r_bm, m.bm, TB_BLACK_MEN_SQUARES);
+        if (wm & bm)
+            return false;
+        const uint32_t wk = unrank(r_wk, m.wk, ~(wm | bm));
+        const uint32_t bk = unrank(r_bk, m.bk, ~(wm | bm | wk));
+        pos.white = wm | wk;
+        pos.black = bm | bk;
+        pos.kings = wk | bk;
+        pos.color = 0;
+        pos.hash = pos.calc_hash();
+        pos.eval = pos.calc_eval();
+        return true;
+    }
+
+private:
+    // Номер набора клеток set среди допустимых клеток allowed
+    static uint64_t rank(uint32_t set, const uint32_t allowed)
+    {
+        uint64_t res = 0;
+        for (int i = 1; set; set &= set - 1, ++i)
+        {
+            const int p = popcount(allowed & ((1u << lsb(set)) - 1));
+            res += binomials.c[p][i];
+        }
+        return res;
+    }
+
+    // Набор из k клеток среди допустимых по его номеру
+    static uint32_t unrank(uint64_t r, const int k, const uint32_t allowed)
+    {
+        uint32_t res = 0;
+        int p = popcount(allowed);
+        for (int i = k; i > 0; --i)
+        {
+            do
+                --p;
+            while (binomials.c[p][i] > r);
+            r -= binomials.c[p][i];
+            res |= 1u << nth_bit(allowed, p);
+        }
+        return res;
+    }
+
+    // Номер клетки n-го (с нуля) установленного бита маски
+    static int nth_bit(uint32_t mask, int n)
+    {
+        while (n--)
+            mask &= mask - 1;
+        return lsb(mask);
+    }
+};
+
+// Таблицы, отображённые в память, и обращение к ним из поиска
+class Tablebase
+{
+public:
+    // Загрузка файла таблиц; при ошибке таблицы остаются выключенными (max_pieces == 0)
+    bool load(const string& path)
+    {
+        max_pieces = 0;
+        memset(slices, 0, sizeof(slices));
+        if (!file.open(path) || file.size < sizeof(TBHeader))
+            return false;
+        TBHeader header;
+        memcpy(&header, file.data, sizeof(header));
+        if (memcmp(header.magic, TB_MAGIC, 4) != 0 || header.version != TB_VERSION ||
+            header.max_pieces > TB_MAX_PIECES ||
+            file.size < sizeof(TBHeader) + uint64_t(header.slice_count) * sizeof(TBSlice))
+        {
+            file.close();
+            return false;
+        }
+        for (uint32_t i = 0; i < header.slice_count; ++i)
+        {
+            TBSlice slice;
+            memcpy(&slice, file.data + sizeof(TBHeader) + i * sizeof(TBSlice), sizeof(slice));
+            const Material m{ slice.wm, slice.wk, slice.bm, slice.bk };
+            if (m.pieces() > int(header.max_pieces) || slice.offset + slice.size > file.size ||
+                slice.size != TBIndex::slice_size(m))
+            {
+                file.close();
+                memset(slices, 0, sizeof(slices));
+                return false;
+            }
+            slices[m.wm][m.wk][m.bm][m.bk] = file.data + slice.offset;
+        }
+        max_pieces = int(header.max_pieces);
+        return true;
+    }
+
+    // Байт таблицы для позиции (см. TBHeader); false, если позиции в таблицах нет
+    bool probe(const Position& pos, int& value) const
+    {
+        if (popcount(pos.occupied()) > max_pieces || !pos.white || !pos.black)
+            return false;
+        const Position norm = pos.color ? flip_position(pos) : pos;
+        const Material m = material_of(norm);
+        const uint8_t* slice = slices[m.wm][m.wk][m.bm][m.bk];
+        if (!slice)
+            return false;
+        value = slice[TBIndex::index(norm)];
+        return true;
+    }
+
+public:
+    int max_pieces = 0; // Наибольшее число фигур в загруженных таблицах (0 — таблиц нет)
+
+private:
+    MappedFile file;
+    const uint8_t* slices[TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1] = {};
+};
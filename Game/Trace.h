@@ -0,0 +1,198 @@
+﻿// Трассировка этапов игры и поиска: время начала и конца каждого этапа по потокам, с выводом в файл
+// формата Chrome trace (открывается в chrome://tracing или ui.perfetto.dev).
+// Каждый поток пишет события в своё кольцо без блокировок; кольца переходят к новым потокам, когда их
+// поток завершается (потоки поиска создаются на каждый ход). Старые события в кольце перезаписываются.
+// Выключена по умолчанию (Game.TracePath); выключенный TraceScope стоит одну проверку флага
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+using namespace std;
+
+// Этап: имя (строковый литерал), начало и конец в наносекундах от запуска
+struct TraceEvent
+{
+    const char* name;
+    int64_t arg;       // Параметр этапа (например, глубина итерации), -1 — нет
+    uint64_t begin_ns;
+    uint64_t end_ns;
+};
+
+class Trace
+{
+public:
+    static const size_t RING_SIZE = 1 << 14; // Событий в кольце одного потока
+    static const int MAX_RINGS = 256;        // Наибольшее число одновременно пишущих потоков
+
+    static void enable(const bool on)
+    {
+        enabled_flag().store(on, memory_order_relaxed);
+    }
+
+    static bool enabled()
+    {
+        return enabled_flag().load(memory_order_relaxed);
+    }
+
+    // Время в наносекундах от первого обращения к трассировке
+    static uint64_t now_ns()
+    {
+        static const auto origin = chrono::steady_clock::now();
+        return uint64_t(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - origin).count());
+    }
+
+    // Запись завершённого этапа в кольцо текущего потока
+    static void record(const char* name, const uint64_t begin_ns, const uint64_t end_ns, const int64_t arg = -1)
+    {
+        Owner& owner = thread_owner();
+        if (!owner.ring && !owner.claim())
+            return; // Все кольца заняты — событие теряется
+        Ring& ring = *owner.ring;
+        const uint64_t head = ring.head.load(memory_order_relaxed);
+        ring.events[head % RING_SIZE] = TraceEvent{ name, arg, begin_ns, end_ns };
+        ring.head.store(head + 1, memory_order_release); // Событие видно читателю только целиком
+    }
+
+    // Запись событий, начавшихся не раньше since_ns, в файл path. Поток в файле — номер кольца: потоки,
+    // сменявшие друг друга на одном кольце, идут одной строкой. Вызывается, когда остальные потоки
+    // не пишут (конец партии): иначе читаемое событие может перезаписываться
+    static bool dump(const string& path, const uint64_t since_ns = 0)
+    {
+        ofstream fout(path, ios_base::trunc);
+        if (!fout)
+            return false;
+        fout << fixed << setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        Registry& reg = registry();
+        const int count = min(reg.count.load(memory_order_acquire), MAX_RINGS);
+        for (int i = 0; i < count; ++i)
+        {
+            const Ring* ring = reg.rings[i].load(memory_order_acquire);
+            if (!ring)
+                continue;
+            const uint64_t head = ring->head.load(memory_order_acquire);
+            for (uint64_t k = head > RING_SIZE ? head - RING_SIZE : 0; k < head; ++k)
+            {
+                const TraceEvent& ev = ring->events[k % RING_SIZE];
+                if (ev.begin_ns < since_ns)
+                    continue;
+                fout << (first ? "\n" : ",\n") << "{\"name\":\"" << ev.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << i
+                     << ",\"ts\":" << ev.begin_ns / 1000.0 << ",\"dur\":"
+                     << (ev.end_ns - ev.begin_ns) / 1000.0;
+                if (ev.arg >= 0)
+                    fout << ",\"args\":{\"value\":" << ev.arg << "}";
+                fout << "}";
+                first = false;
+            }
+        }
+        fout << "\n]}\n";
+        return bool(fout);
+    }
+
+private:
+    struct Ring
+    {
+        atomic<bool> in_use{ false };  // Кольцо принадлежит живому потоку
+        atomic<uint64_t> head{ 0 };    // Число записанных событий за всё время
+        TraceEvent events[RING_SIZE];
+    };
+
+    // Все когда-либо созданные кольца; создаются по мере появления потоков и живут до конца программы
+    struct Registry
+    {
+        atomic<Ring*> rings[MAX_RINGS] = {};
+        atomic<int> count{ 0 };
+
+        ~Registry()
+        {
+            for (auto& ring : rings)
+                delete ring.load();
+        }
+    };
+
+    // Кольцо текущего потока; при завершении потока кольцо освобождается для следующих
+    struct Owner
+    {
+        Ring* ring = nullptr;
+
+        // Свободное кольцо из созданных, иначе новое
+        bool claim()
+        {
+            Registry& reg = registry();
+            const int count = min(reg.count.load(memory_order_acquire), MAX_RINGS);
+            for (int i = 0; i < count; ++i)
+            {
+                Ring* candidate = reg.rings[i].load(memory_order_acquire);
+                bool expected = false;
+                if (candidate && candidate->in_use.compare_exchange_strong(expected, true, memory_order_acquire))
+                {
+                    ring = candidate;
+                    return true;
+                }
+            }
+            const int slot = reg.count.fetch_add(1, memory_order_acq_rel);
+            if (slot >= MAX_RINGS)
+                return false;
+            auto created = make_unique<Ring>();
+            created->in_use.store(true, memory_order_relaxed);
+            ring = created.release();
+            reg.rings[slot].store(ring, memory_order_release);
+            return true;
+        }
+
+        ~Owner()
+        {
+            if (ring)
+                ring->in_use.store(false, memory_order_release);
+        }
+    };
+
+    static atomic<bool>& enabled_flag()
+    {
+        static atomic<bool> flag{ false };
+        return flag;
+    }
+
+    static Registry& registry()
+    {
+        static Registry reg;
+        return reg;
+    }
+
+    static Owner& thread_owner()
+    {
+        static thread_local Owner owner;
+        return owner;
+    }
+};
+
+// Замер этапа от создания объекта до выхода из области видимости; при выключенной трассировке ничего не пишет
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* name, const int64_t arg = -1)
+        : name(name), arg(arg), active(Trace::enabled()), begin_ns(active ? Trace::now_ns() : 0)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (active)
+            Trace::record(name, begin_ns, Trace::now_ns(), arg);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    int64_t arg;
+    bool active;
+    uint64_t begin_ns;
+};
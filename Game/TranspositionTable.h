@@ -0,0 +1,124 @@
+﻿// Таблица транспозиций: кеш результатов поиска по Zobrist-хешу позиции.
+// Общая для всех потоков поиска и работает без блокировок
+#pragma once
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+
+using namespace std;
+
+// Тип оценки, сохранённой в таблице
+enum class Bound : uint8_t
+{
+    EXACT, // Точная оценка
+    LOWER, // Оценка не меньше сохранённой (было отсечение по beta)
+    UPPER  // Оценка не больше сохранённой (ни один ход не улучшил alpha)
+};
+
+struct TTEntry
+{
+    int32_t score = 0;         // Оценка с точки зрения стороны, чья очередь хода
+    int8_t depth = -1;         // Оставшаяся глубина, на которой получена оценка
+    Bound bound = Bound::EXACT;
+    int8_t from = -1, to = -1; // Лучший ход (клетки 0..31), -1 если неизвестен
+};
+
+// Счётчики обращений к таблице; каждый поток ведёт свои, после поиска они суммируются
+struct TTStats
+{
+    uint64_t hits = 0;       // Найдена запись этой позиции
+    uint64_t misses = 0;     // Ячейка пуста
+    uint64_t collisions = 0; // Ячейка занята другой позицией
+
+    TTStats& operator+=(const TTStats& other)
+    {
+        hits += other.hits;
+        misses += other.misses;
+        collisions += other.collisions;
+        return *this;
+    }
+};
+
+class TranspositionTable
+{
+public:
+    // Размер таблицы — наибольшая степень двойки записей, помещающаяся в size_mb мегабайт
+    TranspositionTable(const size_t size_mb = 16)
+    {
+        size_t count = 1024;
+        while (count * 2 * sizeof(Slot) <= (size_mb << 20))
+            count *= 2;
+        table = make_unique<Slot[]>(count);
+        mask = count - 1;
+    }
+
+    // Поиск записи; при успехе запись распаковывается в entry.
+    // Ячейка хранит key ^ data, поэтому запись, разорванная одновременной записью другого потока,
+    // не пройдёт проверку ключа и будет считаться отсутствующей
+    bool probe(const uint64_t key, TTEntry& entry, TTStats& stats) const
+    {
+        const Slot& slot = table[key & mask];
+        const uint64_t data = slot.data.load(memory_order_relaxed);
+        const uint64_t check = slot.key.load(memory_order_relaxed) ^ data;
+        if (check == key && data)
+        {
+            ++stats.hits;
+            unpack(data, entry);
+            return true;
+        }
+        if (data)
+            ++stats.collisions;
+        else
+            ++stats.misses;
+        return false;
+    }
+
+    // Сохранение результата: более глубокий результат той же позиции не затирается менее глубоким
+    void store(const uint64_t key, const int depth, const Bound bound, const int score, const int from, const int to)
+    {
+        Slot& slot = table[key & mask];
+        const uint64_t old_data = slot.data.load(memory_order_relaxed);
+        if ((slot.key.load(memory_order_relaxed) ^ old_data) == key && old_data)
+        {
+            TTEntry old;
+            unpack(old_data, old);
+            if (old.depth > depth)
+                return;
+        }
+        const uint64_t data = uint64_t(uint32_t(score)) | uint64_t(uint8_t(depth)) << 32 |
+                              uint64_t(bound) << 40 | uint64_t(from + 1) << 42 | uint64_t(to + 1) << 48 |
+                              1ull << 63; // Признак занятой ячейки: data никогда не равна нулю
+        slot.key.store(key ^ data, memory_order_relaxed);
+        slot.data.store(data, memory_order_relaxed);
+    }
+
+    // Очистка таблицы (между партиями)
+    void clear()
+    {
+        for (size_t i = 0; i <= mask; ++i)
+        {
+            table[i].key.store(0, memory_order_relaxed);
+            table[i].data.store(0, memory_order_relaxed);
+        }
+    }
+
+private:
+    struct Slot
+    {
+        atomic<uint64_t> key{ 0 };  // Хеш позиции, сложенный по xor с data
+        atomic<uint64_t> data{ 0 }; // Упакованная запись
+    };
+
+    static void unpack(const uint64_t data, TTEntry& entry)
+    {
+        entry.score = int32_t(uint32_t(data));
+        entry.depth = int8_t(data >> 32);
+        entry.bound = Bound(data >> 40 & 3);
+        entry.from = int8_t((data >> 42 & 63) - 1);
+        entry.to = int8_t((data >> 48 & 63) - 1);
+    }
+
+private:
+    unique_ptr<Slot[]> table;
+    size_t mask;
+};
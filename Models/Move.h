@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <stdint.h>
 #include <stdlib.h>
 
 typedef int8_t POS_T;
@@ -9,6 +10,8 @@ struct move_pos
     POS_T x2, y2;           // конечная позиция (куда перемещаем)
     POS_T xb = -1, yb = -1; // координаты побитой фигуры (если был удар), -1 если нет удара
 
+    // Конструктор по умолчанию (для списков ходов фиксированного размера)
+    move_pos() = default;
 
     // Конструктор для обычного хода (без указания побитой фигуры)
     move_pos(const POS_T x, const POS_T y, const POS_T x2, const POS_T y2) : x(x), y(y), x2(x2), y2(y2)
@@ -32,3 +35,79 @@ struct move_pos
     }
 };
 
+// Наибольшее число взятий в одной серии (у соперника не больше 12 фигур)
+const int MAX_CHAIN = 12;
+
+// Полный ход стороны по клеткам 0..31: простой ход или вся серия взятий одной фигурой.
+// Шаги серии восстанавливаются по пути и маске побитых фигур (см. chain_hops в Position.h)
+struct chain_move
+{
+    int8_t from = -1;         // Клетка, с которой начинается ход
+    int8_t length = 0;        // Число шагов: 1 для простого хода, иначе число взятий
+    bool promotes = false;    // Шашка становится дамкой на одном из шагов
+    int8_t path[MAX_CHAIN];   // Клетки, на которые фигура встаёт после каждого шага
+    uint32_t captured = 0;    // Маска побитых фигур
+
+    // Клетка, на которой ход заканчивается
+    int to() const
+    {
+        return path[length - 1];
+    }
+
+    // Одинаковые по результату ходы равны, даже если фигура била в другом порядке
+    bool operator==(const chain_move& other) const
+    {
+        return from == other.from && length == other.length && to() == other.to() &&
+               captured == other.captured && promotes == other.promotes;
+    }
+
+    bool operator!=(const chain_move& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// Максимальное количество ходов в одной позиции
+const int MAX_TURNS = 256;
+
+// Список ходов фиксированного размера — не выделяет память в куче при поиске
+struct move_list
+{
+    chain_move moves[MAX_TURNS];
+    int size = 0;
+
+    void clear()
+    {
+        size = 0;
+    }
+
+    void push_back(const chain_move& turn)
+    {
+        moves[size++] = turn;
+    }
+
+    bool empty() const
+    {
+        return size == 0;
+    }
+
+    chain_move* begin()
+    {
+        return moves;
+    }
+
+    chain_move* end()
+    {
+        return moves + size;
+    }
+
+    const chain_move* begin() const
+    {
+        return moves;
+    }
+
+    const chain_move* end() const
+    {
+        return moves + size;
+    }
+};
@@ -0,0 +1,415 @@
+﻿// Упакованное представление позиции для поиска ходов ботом:
+// три 32-битные маски (белые, чёрные, дамки) над 32 игровыми клетками и сторона, чья очередь хода
+#pragma once
+#include <cctype>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+#include "Move.h"
+#include "Zobrist.h"
+
+using namespace std;
+
+// Индекс младшего установленного бита маски (маска не должна быть пустой)
+inline int lsb(const uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return int(idx);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// Количество установленных битов маски
+inline int popcount(const uint32_t mask)
+{
+#ifdef _MSC_VER
+    return int(__popcnt(mask));
+#else
+    return __builtin_popcount(mask);
+#endif
+}
+
+// Номер игровой клетки (0..31) по координатам доски, -1 для неигровых клеток.
+// Клетки нумеруются построчно: строка x содержит клетки 4x..4x+3
+inline int square_index(const POS_T x, const POS_T y)
+{
+    if (x < 0 || x > 7 || y < 0 || y > 7 || (x + y) % 2 == 0)
+        return -1;
+    return x * 4 + y / 2;
+}
+
+// Координаты доски по номеру игровой клетки
+inline POS_T square_x(const int sq)
+{
+    return POS_T(sq / 4);
+}
+
+inline POS_T square_y(const int sq)
+{
+    return POS_T(2 * (sq % 4) + 1 - (sq / 4) % 2);
+}
+
+// Таблица соседей: square_step[sq][dir] — соседняя по диагонали клетка или -1.
+// Направления: 0 - (-1, -1), 1 - (-1, +1), 2 - (+1, -1), 3 - (+1, +1).
+// Белые шашки ходят в направлениях 0 и 1, чёрные — 2 и 3
+struct SquareSteps
+{
+    int8_t step[32][4];
+
+    SquareSteps()
+    {
+        const POS_T dx[4] = { -1, -1, 1, 1 };
+        const POS_T dy[4] = { -1, 1, -1, 1 };
+        for (int sq = 0; sq < 32; ++sq)
+            for (int dir = 0; dir < 4; ++dir)
+                step[sq][dir] = int8_t(square_index(square_x(sq) + dx[dir], square_y(sq) + dy[dir]));
+    }
+};
+
+inline const SquareSteps square_steps;
+
+// Шаги полного хода в координатах доски (для показа хода и пошагового ввода игрока).
+// Побитая на шаге фигура — единственная ещё не снятая фигура из маски captured между клетками шага
+inline vector<move_pos> chain_hops(const chain_move& turn)
+{
+    vector<move_pos> hops;
+    uint32_t remaining = turn.captured;
+    int from = turn.from;
+    for (int i = 0; i < turn.length; ++i)
+    {
+        const int to = turn.path[i];
+        const int dir = (square_x(to) > square_x(from) ? 2 : 0) + (square_y(to) > square_y(from) ? 1 : 0);
+        int beat = -1;
+        for (int sq = square_steps.step[from][dir]; sq != to; sq = square_steps.step[sq][dir])
+        {
+            if (remaining >> sq & 1)
+            {
+                beat = sq;
+                break;
+            }
+        }
+        if (beat != -1)
+        {
+            remaining &= ~(1u << beat);
+            hops.push_back(move_pos(square_x(from), square_y(from), square_x(to), square_y(to), square_x(beat),
+                                    square_y(beat)));
+        }
+        else
+        {
+            hops.push_back(move_pos(square_x(from), square_y(from), square_x(to), square_y(to)));
+        }
+        from = to;
+    }
+    return hops;
+}
+
+// Продвижение шашки на клетке sq — число рядов, пройденных к превращению в дамку
+inline int man_advance(const bool side, const int sq)
+{
+    return side ? square_x(sq) : 7 - square_x(sq);
+}
+
+// Слагаемые оценки позиции по сторонам (0 - белые, 1 - чёрные).
+// Обновляются каждым ходом, поэтому оценка листа не требует обхода доски
+struct EvalTerms
+{
+    int16_t men[2] = { 0, 0 };     // Число шашек
+    int16_t kings[2] = { 0, 0 };   // Число дамок
+    int16_t advance[2] = { 0, 0 }; // Сумма продвижения шашек (см. man_advance)
+
+    bool operator==(const EvalTerms& other) const
+    {
+        for (int side = 0; side < 2; ++side)
+        {
+            if (men[side] != other.men[side] || kings[side] != other.kings[side] ||
+                advance[side] != other.advance[side])
+                return false;
+        }
+        return true;
+    }
+};
+
+// Данные для отмены хода: побитые дамки (побитые фигуры известны из хода), изменение хеша
+// и слагаемые оценки до хода
+struct undo_info
+{
+    uint32_t captured_kings = 0; // Маска побитых дамок
+    uint64_t hash_delta = 0;     // Хеш до хода = хеш после хода ^ hash_delta
+    EvalTerms eval;              // Слагаемые оценки до хода
+};
+
+struct Position
+{
+    uint32_t white = 0; // Маска белых фигур
+    uint32_t black = 0; // Маска чёрных фигур
+    uint32_t kings = 0; // Маска дамок обоих цветов
+    bool color = 0;     // Сторона, чья очередь хода: 0 - белые, 1 - чёрные
+    uint64_t hash = 0;  // Zobrist-хеш, обновляется инкрементально при каждом ходе
+    EvalTerms eval;     // Слагаемые оценки, обновляются инкрементально при каждом ходе
+
+    Position() = default;
+
+    // Упаковка матрицы доски (0 - пусто, 1/2 - белая/чёрная шашка, 3/4 - белая/чёрная дамка)
+    Position(const vector<vector<POS_T>>& mtx, const bool color) : color(color)
+    {
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                const int sq = square_index(i, j);
+                if (sq == -1 || !mtx[i][j])
+                    continue;
+                const uint32_t bit = 1u << sq;
+                if (mtx[i][j] % 2)
+                    white |= bit;
+                else
+                    black |= bit;
+                if (mtx[i][j] > 2)
+                    kings |= bit;
+            }
+        }
+        hash = calc_hash();
+        eval = calc_eval();
+    }
+
+    // Начальная расстановка: чёрные на клетках 0..11, белые на 20..31, ходят белые
+    static Position start()
+    {
+        Position pos;
+        pos.black = 0x00000FFFu;
+        pos.white = 0xFFF00000u;
+        pos.hash = pos.calc_hash();
+        pos.eval = pos.calc_eval();
+        return pos;
+    }
+
+    // Разбор строки в формате FEN для шашек: "W:W21,22,K30:B1,2,K5".
+    // Первая буква — чья очередь хода, далее списки белых и чёрных фигур, K — дамка.
+    // Клетки нумеруются 1..32 (номер клетки поиска + 1): 1..4 — верхний ряд, где стоят чёрные
+    static Position from_fen(const string& fen)
+    {
+        Position pos;
+        auto fail = [&fen]() { throw runtime_error("can't parse position \"" + fen + "\""); };
+        if (fen.empty() || (fen[0] != 'W' && fen[0] != 'B'))
+            fail();
+        pos.color = fen[0] == 'B';
+        size_t i = 1;
+        while (i < fen.size())
+        {
+            if (fen[i] != ':' || i + 1 >= fen.size() || (fen[i + 1] != 'W' && fen[i + 1] != 'B'))
+                fail();
+            uint32_t& side = fen[i + 1] == 'W' ? pos.white : pos.black;
+            i += 2;
+            while (i < fen.size() && fen[i] != ':')
+            {
+                if (fen[i] == ',')
+                {
+                    ++i;
+                    continue;
+                }
+                const bool king = fen[i] == 'K';
+                if (king)
+                    ++i;
+                int num = 0;
+                const size_t begin = i;
+                while (i < fen.size() && isdigit(static_cast<unsigned char>(fen[i])))
+                    num = num * 10 + (fen[i++] - '0');
+                if (i == begin || num < 1 || num > 32)
+                    fail();
+                side |= 1u << (num - 1);
+                if (king)
+                    pos.kings |= 1u << (num - 1);
+            }
+        }
+        if (pos.white & pos.black)
+            fail();
+        pos.hash = pos.calc_hash();
+        pos.eval = pos.calc_eval();
+        return pos;
+    }
+
+    // Запись позиции в формате FEN (см. from_fen)
+    string to_fen() const
+    {
+        string res(1, color ? 'B' : 'W');
+        for (int side = 0; side < 2; ++side)
+        {
+            res += side ? ":B" : ":W";
+            bool first = true;
+            for (uint32_t m = pieces(side); m; m &= m - 1)
+            {
+                const int sq = lsb(m);
+                if (!first)
+                    res += ',';
+                first = false;
+                if (kings >> sq & 1)
+                    res += 'K';
+                res += to_string(sq + 1);
+            }
+        }
+        return res;
+    }
+
+    // Полный пересчёт хеша (при обычной работе хеш обновляется по разнице ходов)
+    uint64_t calc_hash() const
+    {
+        uint64_t res = color ? zobrist.side : 0;
+        for (uint32_t m = occupied(); m; m &= m - 1)
+        {
+            const int sq = lsb(m);
+            res ^= zobrist.piece[at(sq) - 1][sq];
+        }
+        return res;
+    }
+
+    // Полный пересчёт слагаемых оценки
+    EvalTerms calc_eval() const
+    {
+        EvalTerms res;
+        for (int side = 0; side < 2; ++side)
+        {
+            const uint32_t men = pieces(side) & ~kings;
+            res.men[side] = int16_t(popcount(men));
+            res.kings[side] = int16_t(popcount(pieces(side) & kings));
+            for (uint32_t m = men; m; m &= m - 1)
+                res.advance[side] += int16_t(man_advance(side, lsb(m)));
+        }
+        return res;
+    }
+
+    // Передача очереди хода сопернику
+    void pass_turn()
+    {
+        color = !color;
+        hash ^= zobrist.side;
+    }
+
+    // Выполняет полный ход на месте, передаёт очередь хода сопернику и запоминает, как его отменить.
+    // Дамка может закончить серию взятий на клетке, с которой начала, поэтому from и to не обязательно различны
+    void do_move(const chain_move& turn, undo_info& undo)
+    {
+        const int to = turn.to();
+        const uint32_t from_bit = 1u << turn.from, to_bit = 1u << to;
+        const POS_T type = at(turn.from);
+        const bool is_white = white & from_bit;
+        const bool side = !is_white;
+        uint64_t delta = zobrist.side ^ zobrist.piece[type - 1][turn.from] ^
+                         zobrist.piece[type - 1 + (turn.promotes ? 2 : 0)][to];
+        undo.eval = eval;
+        if (type <= 2)
+        {
+            eval.advance[side] -= int16_t(man_advance(side, turn.from));
+            if (turn.promotes)
+            {
+                --eval.men[side];
+                ++eval.kings[side];
+            }
+            else
+            {
+                eval.advance[side] += int16_t(man_advance(side, to));
+            }
+        }
+        for (uint32_t m = turn.captured; m; m &= m - 1)
+        {
+            const int sq = lsb(m);
+            const bool beat_king = kings >> sq & 1;
+            // Побитая фигура — соперника: белая (тип 1 или 3), если ходят чёрные
+            delta ^= zobrist.piece[(side ? 0 : 1) + (beat_king ? 2 : 0)][sq];
+            if (beat_king)
+            {
+                --eval.kings[!side];
+            }
+            else
+            {
+                --eval.men[!side];
+                eval.advance[!side] -= int16_t(man_advance(!side, sq));
+            }
+        }
+
+        uint32_t& own = is_white ? white : black;
+        uint32_t& enemy = is_white ? black : white;
+        undo.captured_kings = kings & turn.captured;
+        enemy &= ~turn.captured;
+        kings &= ~turn.captured;
+        own = (own & ~from_bit) | to_bit;
+        if (kings & from_bit)
+            kings = (kings & ~from_bit) | to_bit;
+        else if (turn.promotes)
+            kings |= to_bit; // Превращение в дамку
+
+        color = !color;
+        hash ^= delta;
+        undo.hash_delta = delta;
+    }
+
+    // Отменяет ход, выполненный do_move
+    void undo_move(const chain_move& turn, const undo_info& undo)
+    {
+        const int to = turn.to();
+        const uint32_t from_bit = 1u << turn.from, to_bit = 1u << to;
+        const bool is_white = white & to_bit;
+        uint32_t& own = is_white ? white : black;
+        uint32_t& enemy = is_white ? black : white;
+
+        own = (own & ~to_bit) | from_bit;
+        if (turn.promotes)
+            kings &= ~to_bit;
+        else if (kings & to_bit)
+            kings = (kings & ~to_bit) | from_bit;
+        enemy |= turn.captured;
+        kings |= undo.captured_kings;
+
+        color = !color;
+        hash ^= undo.hash_delta;
+        eval = undo.eval;
+    }
+
+    // Распаковка обратно в матрицу доски
+    vector<vector<POS_T>> to_matrix() const
+    {
+        vector<vector<POS_T>> mtx(8, vector<POS_T>(8, 0));
+        for (int sq = 0; sq < 32; ++sq)
+            mtx[square_x(sq)][square_y(sq)] = at(sq);
+        return mtx;
+    }
+
+    // Фигура на клетке в кодировке матрицы доски
+    POS_T at(const int sq) const
+    {
+        const uint32_t bit = 1u << sq;
+        if (!((white | black) & bit))
+            return 0;
+        return POS_T(((white & bit) ? 1 : 2) + ((kings & bit) ? 2 : 0));
+    }
+
+    POS_T at(const POS_T x, const POS_T y) const
+    {
+        const int sq = square_index(x, y);
+        return sq == -1 ? 0 : at(sq);
+    }
+
+    // Маска фигур заданного цвета
+    uint32_t pieces(const bool side) const
+    {
+        return side ? black : white;
+    }
+
+    uint32_t occupied() const
+    {
+        return white | black;
+    }
+
+    bool operator==(const Position& other) const
+    {
+        return white == other.white && black == other.black && kings == other.kings && color == other.color;
+    }
+};
@@ -7,5 +7,6 @@ enum class Response
     BACK,     // Игрок запросил откат последнего хода
     REPLAY,   // Игрок хочет начать игру заново
     QUIT,     // Игрок завершает игру (выход)
-    CELL      // Игрок кликнул на игровую клетку (используется при выборе хода)
+    CELL,     // Игрок кликнул на игровую клетку (используется при выборе хода)
+    ENGINE    // Фоновый поиск бота завершился (событие от потока поиска, а не от игрока)
 };
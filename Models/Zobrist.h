@@ -0,0 +1,31 @@
+﻿// Ключи Zobrist-хеширования позиции: по ключу на каждый тип фигуры на каждой игровой клетке и ключ очереди хода
+#pragma once
+#include <stdint.h>
+
+struct Zobrist
+{
+    uint64_t piece[4][32]; // [тип фигуры - 1][клетка], типы как в матрице доски: 1..4
+    uint64_t side;         // Добавляется, когда ходят чёрные
+
+    Zobrist()
+    {
+        // Фиксированное зерно: хеши одинаковы между запусками и могут храниться в файлах
+        uint64_t seed = 0x9E3779B97F4A7C15ull;
+        for (int type = 0; type < 4; ++type)
+            for (int sq = 0; sq < 32; ++sq)
+                piece[type][sq] = next(seed);
+        side = next(seed);
+    }
+
+private:
+    // Генератор splitmix64
+    static uint64_t next(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+inline const Zobrist zobrist;
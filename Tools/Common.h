@@ -0,0 +1,45 @@
+﻿// Общее для консольных инструментов: запись ходов и правила партии без окна
+#pragma once
+#include <algorithm>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "../Models/Position.h"
+
+using namespace std;
+
+// Запись хода в нотации с номерами клеток 1..32: "22-18" или серия взятий "22x15x6"
+inline string turn_to_string(const chain_move& turn)
+{
+    string res = to_string(turn.from + 1);
+    for (int i = 0; i < turn.length; ++i)
+        res += (turn.captured ? "x" : "-") + to_string(turn.path[i] + 1);
+    return res;
+}
+
+// Повторения позиций партии — по тому же правилу, что и в окне (GameState::repetitions): позиция,
+// встретившаяся в третий раз, — ничья. Взятие и ход простой шашки необратимы, после них прошлые
+// позиции уже не повторятся
+class RepetitionHistory
+{
+public:
+    // Учёт хода turn из позиции pos (до того, как ход сделан)
+    void add(const Position& pos, const chain_move& turn)
+    {
+        if (turn.captured || !(pos.kings & (1u << turn.from)))
+            hashes.clear();
+        else
+            hashes.push_back(pos.hash);
+    }
+
+    // Сколько раз позиция pos уже встречалась раньше
+    int repetitions(const Position& pos) const
+    {
+        return int(count(hashes.begin(), hashes.end(), pos.hash));
+    }
+
+private:
+    vector<uint64_t> hashes; // Позиции перед обратимыми ходами после последнего необратимого
+};
@@ -0,0 +1,266 @@
+﻿// Замер скорости поиска бота без графики: время до заданной глубины при разном числе потоков
+// и проверка того, что поиск после настройки не выделяет память в куче.
+// Качество порядка ходов — доля отсечений на первом ходе узла и число узлов с упорядочиванием и без него.
+// Доля оценки позиции во времени поиска — при пересчёте слагаемых по доске и при их обновлении ходами.
+// Пакетная оценка (BatchEval) на каждом доступном наборе инструкций — скорость и совпадение с calc_score.
+// Сборка (из корня проекта): g++ -std=c++17 -O2 -pthread -I<путь к nlohmann/json> Tools/bench.cpp -o bench
+// Запуск из корня проекта (читается settings.json): ./bench [глубина] [список потоков]
+// Пример: ./bench 14 1,2,4,8,16
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+#include "../Game/Logic.h"
+
+// Счётчик выделений памяти в куче во всей программе
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic ignored "-Wmismatched-new-delete" // Замена operator new через malloc
+#endif
+static atomic<uint64_t> allocations{ 0 };
+
+// Сумма оценок в замере оценки — не даёт компилятору выбросить сам замер
+static volatile int64_t eval_sink = 0;
+
+void* operator new(size_t size)
+{
+    ++allocations;
+    if (void* ptr = malloc(size ? size : 1))
+        return ptr;
+    throw bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+// Набор позиций: начальная и позиции после нескольких ходов неглубокого поиска
+vector<Position> bench_positions(Config& config)
+{
+    vector<Position> res;
+    Logic logic(nullptr, &config);
+    logic.seed(1);
+    logic.Max_depth = 3;
+    logic.time_limit_ms = 0;
+    logic.threads = 1;
+
+    Position pos = Position::start();
+    res.push_back(pos);
+    for (int ply = 1; ply <= 24; ++ply)
+    {
+        const chain_move turn = logic.find_best_turn(pos);
+        if (turn.from == -1)
+            break;
+        pos = logic.make_turn(pos, turn);
+        if (ply % 8 == 0)
+            res.push_back(pos);
+    }
+    return res;
+}
+
+// Позиции для замера оценки: случайные партии из позиций набора
+vector<Position> eval_positions(const vector<Position>& starts, const int count)
+{
+    vector<Position> res;
+    default_random_engine rng(1);
+    while (int(res.size()) < count)
+    {
+        Position pos = starts[res.size() % starts.size()];
+        for (int ply = 0; ply < 40 && int(res.size()) < count; ++ply)
+        {
+            move_list turns;
+            bool beats;
+            MoveGen::find_turns(pos, turns, beats);
+            if (turns.empty())
+                break;
+            undo_info undo;
+            pos.do_move(turns.moves[rng() % turns.size], undo);
+            res.push_back(pos);
+        }
+    }
+    return res;
+}
+
+int main(int argc, char* argv[])
+{
+    const int depth = argc > 1 ? atoi(argv[1]) : 14;
+    vector<int> thread_counts = { 1, 2, 4, 8, 16 };
+    if (argc > 2)
+    {
+        thread_counts.clear();
+        stringstream ss(argv[2]);
+        string item;
+        while (getline(ss, item, ','))
+            thread_counts.push_back(atoi(item.c_str()));
+    }
+
+    Config config;
+    config.set("Bot", "BookPath", ""); // Замеряется поиск, а не дебютная книга
+    const auto positions = bench_positions(config);
+
+    // Горячий путь поиска (итеративное углубление одного потока) на уже созданных структурах
+    {
+        Logic logic(nullptr, &config);
+        logic.seed(1);
+        logic.Max_depth = depth - 1;
+        logic.time_limit_ms = 0;
+        logic.threads = 1;
+        auto th = make_unique<SearchThread>();
+        uint64_t nodes = 0, allocs = 0;
+        for (const auto& pos : positions)
+        {
+            logic.tt.clear();
+            const uint64_t before = allocations;
+            logic.iterative_deepening(*th, pos, depth);
+            allocs += allocations - before;
+            nodes += th->stats.nodes;
+        }
+        cout << "Heap allocations in search: " << allocs << " over " << nodes << " nodes ("
+             << double(allocs) / max<uint64_t>(nodes, 1) << " per node)\n\n";
+    }
+
+    // Порядок ходов на одной глубине в один поток: без упорядочивания первыми идут только ход
+    // главного варианта и ход из таблицы транспозиций; "history" — без пакетной оценки тихих ходов
+    cout << "Move ordering at depth " << depth << "\n";
+    cout << setw(14) << "ordering" << setw(14) << "nodes" << setw(12) << "time ms" << setw(14) << "1st-move cut"
+         << "\n";
+    for (const int mode : { 0, 1, 2 })
+    {
+        Logic logic(nullptr, &config);
+        logic.seed(1);
+        logic.Max_depth = depth - 1;
+        logic.time_limit_ms = 0;
+        logic.threads = 1;
+        logic.use_ordering = mode > 0;
+        logic.eval_ordering = mode > 1;
+
+        double total_ms = 0;
+        uint64_t total_nodes = 0, cutoffs = 0, first_move_cutoffs = 0;
+        for (const auto& pos : positions)
+        {
+            logic.tt.clear();
+            auto start = chrono::steady_clock::now();
+            logic.find_best_turn(pos);
+            auto end = chrono::steady_clock::now();
+            total_ms += chrono::duration<double, milli>(end - start).count();
+            total_nodes += logic.stats.nodes;
+            cutoffs += logic.stats.cutoffs;
+            first_move_cutoffs += logic.stats.first_move_cutoffs();
+        }
+        cout << setw(14) << (mode == 0 ? "off" : mode == 1 ? "history" : "history+eval") << setw(14) << total_nodes << setw(12) << fixed
+             << setprecision(1) << total_ms << setw(13) << 100.0 * first_move_cutoffs / max<uint64_t>(cutoffs, 1)
+             << "%\n";
+    }
+    cout << "\n";
+
+    // Оценка позиции: время одного вызова на наборе позиций и число оценок в поиске на той же глубине
+    cout << "Evaluation at depth " << depth << "\n";
+    cout << setw(12) << "eval" << setw(12) << "time ms" << setw(14) << "evals" << setw(10) << "ns/eval" << setw(12)
+         << "eval share" << "\n";
+    const auto sample = eval_positions(positions, 100000);
+    for (const bool incremental : { false, true })
+    {
+        Logic logic(nullptr, &config);
+        logic.seed(1);
+        logic.Max_depth = depth - 1;
+        logic.time_limit_ms = 0;
+        logic.threads = 1;
+        logic.incremental_eval = incremental;
+
+        double total_ms = 0;
+        uint64_t evals = 0;
+        for (const auto& pos : positions)
+        {
+            logic.tt.clear();
+            auto start = chrono::steady_clock::now();
+            logic.find_best_turn(pos);
+            auto end = chrono::steady_clock::now();
+            total_ms += chrono::duration<double, milli>(end - start).count();
+            evals += logic.stats.evals;
+        }
+
+        const int rounds = 20;
+        int64_t checksum = 0;
+        auto start = chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round)
+            for (const auto& pos : sample)
+                checksum += logic.calc_score(pos);
+        auto end = chrono::steady_clock::now();
+        const double ns = chrono::duration<double, nano>(end - start).count() / (double(rounds) * sample.size());
+
+        cout << setw(12) << (incremental ? "incremental" : "recompute") << setw(12) << fixed << setprecision(1)
+             << total_ms << setw(14) << evals << setw(10) << setprecision(2) << ns << setw(11) << setprecision(1)
+             << 100.0 * evals * ns / 1e6 / max(total_ms, 1e-3) << "%\n";
+        eval_sink = checksum;
+    }
+    cout << "\n";
+
+    // Пакетная оценка того же набора позиций на каждом наборе инструкций, доступном процессору
+    {
+        Logic logic(nullptr, &config);
+        vector<int> expected(sample.size()), scores(sample.size());
+        for (size_t i = 0; i < sample.size(); ++i)
+            expected[i] = logic.calc_score(sample[i]);
+        cout << "Batch evaluation (best: " << BatchEval::isa_name(BatchEval::best_isa()) << ")\n";
+        cout << setw(12) << "isa" << setw(10) << "ns/pos" << setw(12) << "mismatches" << "\n";
+        for (const auto isa : { BatchEval::Isa::SCALAR, BatchEval::Isa::SSE2, BatchEval::Isa::AVX2 })
+        {
+            if (isa > BatchEval::best_isa())
+                continue;
+            const int rounds = 200;
+            auto start = chrono::steady_clock::now();
+            for (int round = 0; round < rounds; ++round)
+                BatchEval::evaluate(sample.data(), int(sample.size()), logic.weights, scores.data(), isa);
+            auto end = chrono::steady_clock::now();
+            const double ns = chrono::duration<double, nano>(end - start).count() / (double(rounds) * sample.size());
+            int mismatches = 0;
+            for (size_t i = 0; i < sample.size(); ++i)
+                mismatches += scores[i] != expected[i];
+            cout << setw(12) << BatchEval::isa_name(isa) << setw(10) << fixed << setprecision(2) << ns << setw(12)
+                 << mismatches << "\n";
+            eval_sink = scores[0];
+        }
+    }
+    cout << "\n";
+
+    cout << "Time to depth " << depth << " over " << positions.size() << " positions\n";
+    cout << setw(8) << "threads" << setw(12) << "time ms" << setw(10) << "speedup" << setw(14) << "nodes"
+         << setw(12) << "knps" << "\n";
+
+    double base_time = 0;
+    for (const int threads : thread_counts)
+    {
+        Logic logic(nullptr, &config);
+        logic.seed(1);
+        logic.Max_depth = depth - 1;
+        logic.time_limit_ms = 0;
+        logic.threads = threads;
+
+        double total_ms = 0;
+        uint64_t total_nodes = 0;
+        for (const auto& pos : positions)
+        {
+            logic.tt.clear();
+            auto start = chrono::steady_clock::now();
+            logic.find_best_turn(pos);
+            auto end = chrono::steady_clock::now();
+            total_ms += chrono::duration<double, milli>(end - start).count();
+            total_nodes += logic.stats.nodes;
+        }
+        if (base_time == 0)
+            base_time = total_ms;
+
+        cout << setw(8) << threads << setw(12) << fixed << setprecision(1) << total_ms << setw(10)
+             << setprecision(2) << base_time / total_ms << setw(14) << total_nodes << setw(12) << setprecision(0)
+             << total_nodes / max(total_ms, 1e-3) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+﻿// Построение дебютной книги: обход дерева дебюта от начальной позиции с глубоким поиском каждого хода.
+// В книгу попадают ходы, оценка которых не хуже лучшей больше чем на margin; вес хода тем больше,
+// чем ближе он к лучшему. Дальше дерево раскрывается только по ходам книги.
+// Сборка (из корня проекта): g++ -std=c++17 -O2 -pthread -I<путь к nlohmann/json> Tools/bookgen.cpp -o bookgen
+// Запуск из корня проекта (читается settings.json):
+//   ./bookgen [--plies 8] [--depth 10] [--margin 20] [--max-positions 5000] [--threads N] [--out book.bin]
+// Параметры:
+//   --plies N          глубина книги в полуходах
+//   --depth N          глубина поиска для оценки каждого хода
+//   --margin N         допустимое отставание от лучшего хода в сотых долях шашки
+//   --max-positions N  наибольшее число позиций в книге
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <unordered_set>
+
+#include "../Game/Logic.h"
+
+// Ходы книги для одной позиции
+struct BookNode
+{
+    Position pos;
+    vector<BookEntry> entries;
+    vector<Position> children; // Позиции после ходов книги
+};
+
+// Оценка всех ходов позиции поиском и отбор ходов книги
+void expand(Logic& logic, BookNode& node, const int margin)
+{
+    move_list turns;
+    bool beats;
+    MoveGen::find_turns(node.pos, turns, beats);
+    vector<int> scores;
+    int best = -INF;
+    for (const auto& turn : turns)
+    {
+        logic.find_best_turn(logic.make_turn(node.pos, turn));
+        scores.push_back(-logic.best_score); // Оценка соперника после хода — с обратным знаком
+        best = max(best, scores.back());
+    }
+    for (int i = 0; i < turns.size; ++i)
+    {
+        const int diff = best - scores[i];
+        if (diff > margin)
+            continue;
+        const chain_move& turn = turns.moves[i];
+        BookEntry entry;
+        entry.key = node.pos.hash;
+        entry.captured = turn.captured;
+        entry.from = uint8_t(turn.from);
+        entry.to = uint8_t(turn.to());
+        entry.weight = uint16_t(margin ? 1 + (margin - diff) * 99 / margin : 100);
+        node.entries.push_back(entry);
+        node.children.push_back(logic.make_turn(node.pos, turn));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int plies = 8, depth = 10, margin = 20, max_positions = 5000;
+    int workers = max(1, int(thread::hardware_concurrency()));
+    string out = "book.bin";
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "--plies"))
+            plies = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--depth"))
+            depth = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--margin"))
+            margin = max(0, atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "--max-positions"))
+            max_positions = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--threads"))
+            workers = max(1, atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "--out"))
+            out = argv[i + 1];
+    }
+
+    Config config;
+    config.set("Bot", "BookPath", ""); // Книга строится поиском, а не по старой книге
+    config.set("Bot", "NoRandom", true);
+    config.set("Bot", "HashMB", 16);
+    cout << "Building opening book: " << plies << " plies, depth " << depth << ", margin " << margin << ", "
+         << workers << " threads\n";
+    auto start = chrono::steady_clock::now();
+
+    vector<BookEntry> book;
+    unordered_set<uint64_t> seen;
+    vector<Position> frontier = { Position::start() };
+    seen.insert(frontier[0].hash);
+    int positions = 0;
+    for (int ply = 0; ply < plies && !frontier.empty() && positions < max_positions; ++ply)
+    {
+        if (positions + int(frontier.size()) > max_positions)
+            frontier.resize(max_positions - positions);
+        positions += int(frontier.size());
+
+        // Позиции одного полухода независимы и делятся между потоками
+        vector<BookNode> nodes(frontier.size());
+        for (size_t i = 0; i < frontier.size(); ++i)
+            nodes[i].pos = frontier[i];
+        atomic<size_t> next_node{ 0 };
+        auto worker = [&]() {
+            Logic logic(nullptr, &config);
+            logic.Max_depth = depth - 1;
+            logic.time_limit_ms = 0;
+            logic.threads = 1;
+            while (true)
+            {
+                const size_t i = next_node++;
+                if (i >= nodes.size())
+                    break;
+                expand(logic, nodes[i], margin);
+            }
+        };
+        vector<thread> pool;
+        for (int i = 1; i < workers; ++i)
+            pool.emplace_back(worker);
+        worker();
+        for (auto& th : pool)
+            th.join();
+
+        frontier.clear();
+        for (const auto& node : nodes)
+        {
+            book.insert(book.end(), node.entries.begin(), node.entries.end());
+            for (const auto& child : node.children)
+            {
+                if (seen.insert(child.hash).second)
+                    frontier.push_back(child);
+            }
+        }
+        cout << "  ply " << setw(2) << ply + 1 << ": " << setw(6) << nodes.size() << " positions, " << setw(7)
+             << book.size() << " book moves" << endl;
+    }
+
+    sort(book.begin(), book.end(), [](const BookEntry& a, const BookEntry& b) {
+        return a.key != b.key ? a.key < b.key : a.weight > b.weight;
+    });
+    FILE* fout = fopen(out.c_str(), "wb");
+    if (!fout)
+    {
+        cout << "bookgen: can't write " << out << "\n";
+        return 1;
+    }
+    BookHeader header;
+    memcpy(header.magic, BOOK_MAGIC, 4);
+    header.version = BOOK_VERSION;
+    header.count = book.size();
+    fwrite(&header, sizeof(header), 1, fout);
+    fwrite(book.data(), sizeof(BookEntry), book.size(), fout);
+    const bool ok = !ferror(fout);
+    if (fclose(fout) != 0 || !ok)
+    {
+        cout << "bookgen: can't write " << out << "\n"; // Обрезанную книгу OpeningBook::load не примет
+        return 1;
+    }
+
+    const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Saved " << out << ": " << positions << " positions, " << book.size() << " moves, "
+         << sizeof(header) + book.size() * sizeof(BookEntry) << " bytes in " << fixed << setprecision(1) << sec
+         << " s\n";
+    return 0;
+}
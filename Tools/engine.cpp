@@ -0,0 +1,343 @@
+﻿// Движок с текстовым протоколом через stdin/stdout: анализ позиций без окна, из скрипта или из внешней
+// оболочки, подключённой через канал. Одна команда — одна строка, каждая строка ответа сразу выталкивается.
+// Поиск — тот же Logic с настройками из settings.json, что и у бота в игре.
+// Сборка (из корня проекта): g++ -std=c++17 -O2 -pthread -I<путь к nlohmann/json> Tools/engine.cpp -o engine
+// Запуск из корня проекта: ./engine, затем команды:
+//   isready                                   — ответ readyok
+//   newgame                                   — очистка таблицы транспозиций
+//   position startpos [moves 22-18 11-15 ...] — начальная позиция и ходы после неё
+//   position fen W:W21,22:B1,2 [moves ...]    — позиция в FEN и ходы после неё
+//   setoption name <ключ раздела Bot> value <значение> — переопределение настройки, например Threads или HashMB
+//   go [depth N] [movetime MS] [infinite]     — поиск в фоне: строка info после каждой итерации и bestmove.
+//                                               Без параметров — глубина BlackBotLevel + 1 и время BotTimeMS
+//   stop                                      — остановка поиска, bestmove по последней завершённой итерации
+//   batch <файл> [depth N] [movetime MS] [threads N] — анализ файла позиций (FEN по строке) в N потоков:
+//                                               строка result на позицию в порядке готовности и итог batchdone
+//   d                                         — текущая позиция в FEN
+//   quit                                      — выход с остановкой поиска
+// Пока идёт поиск, остальные команды (кроме isready и stop) ждут его окончания.
+// Строка info: depth D score S nodes N nps X time MS pv ... Оценка — в сотых долях шашки за сторону,
+// чья очередь, или "win K"/"loss K" — выигрыш/проигрыш через K полуходов; узлы — основного потока
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+#include "../Game/Logic.h"
+#include "Common.h"
+
+// Оценка для строки info
+string score_to_string(const int score)
+{
+    if (score > WIN_BOUND)
+        return "win " + to_string(WIN_SCORE - score);
+    if (score < -WIN_BOUND)
+        return "loss " + to_string(WIN_SCORE + score);
+    return to_string(score);
+}
+
+// Ход позиции pos в нотации text; false — такого хода нет
+bool parse_turn(const Position& pos, const string& text, chain_move& res)
+{
+    move_list turns;
+    bool beats;
+    MoveGen::find_turns(pos, turns, beats);
+    for (const auto& turn : turns)
+    {
+        if (turn_to_string(turn) == text)
+        {
+            res = turn;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Ограничения одного поиска
+struct SearchLimits
+{
+    int depth = 0;        // Глубина в полуходах (0 — без ограничения)
+    int movetime_ms = 0;  // Время в миллисекундах (0 — без ограничения)
+};
+
+// Разбор "depth N", "movetime MS", "infinite" и "threads N" из остатка команды
+SearchLimits parse_limits(istringstream& in, const SearchLimits& defaults, int* workers = nullptr)
+{
+    SearchLimits res = defaults;
+    string key;
+    while (in >> key)
+    {
+        if (key == "depth")
+        {
+            in >> res.depth;
+            if (res.movetime_ms == defaults.movetime_ms)
+                res.movetime_ms = 0; // Только глубина — время не ограничено
+        }
+        else if (key == "movetime")
+        {
+            in >> res.movetime_ms;
+            if (res.depth == defaults.depth)
+                res.depth = 0; // Только время — глубина не ограничена
+        }
+        else if (key == "infinite")
+            res.depth = res.movetime_ms = 0;
+        else if (key == "threads" && workers)
+            in >> *workers;
+    }
+    return res;
+}
+
+// Настройка Logic под ограничения поиска
+void apply_limits(Logic& logic, const SearchLimits& limits)
+{
+    // Поиск идёт до глубины Max_depth + 1
+    logic.Max_depth = limits.depth > 0 ? min(limits.depth, MAX_PLY - 2) - 1 : MAX_PLY - 3;
+    logic.time_limit_ms = limits.movetime_ms;
+}
+
+class Engine
+{
+public:
+    Engine()
+    {
+        defaults.depth = int(config("Bot", "BlackBotLevel")) + 1;
+        defaults.movetime_ms = config("Bot", "BotTimeMS");
+        logic = make_unique<Logic>(nullptr, &config);
+    }
+
+    // Конец ввода без quit — текущий поиск доводится до конца (удобно для команд из файла через канал)
+    ~Engine()
+    {
+        wait_search();
+    }
+
+    // Обработка одной строки; false — команда quit
+    bool command(const string& line)
+    {
+        istringstream in(line);
+        string cmd;
+        if (!(in >> cmd))
+            return true;
+        if (cmd == "isready")
+            say("readyok");
+        else if (cmd == "stop")
+            stop();
+        else if (cmd == "quit")
+        {
+            stop();
+            return false;
+        }
+        else
+        {
+            wait_search();
+            if (cmd == "newgame")
+                logic->tt.clear();
+            else if (cmd == "position")
+                set_position(in);
+            else if (cmd == "setoption")
+                set_option(in);
+            else if (cmd == "go")
+                go(parse_limits(in, defaults));
+            else if (cmd == "batch")
+                batch(in);
+            else if (cmd == "d")
+                say(pos.to_fen());
+            else
+                say("info string unknown command " + cmd);
+        }
+        return true;
+    }
+
+private:
+    // Вывод строки целиком: строки потока поиска и ответы на команды не перемешиваются
+    void say(const string& text)
+    {
+        lock_guard<mutex> lock(out_mutex);
+        cout << text << endl;
+    }
+
+    void set_position(istringstream& in)
+    {
+        string kind, token;
+        in >> kind;
+        Position next;
+        try
+        {
+            if (kind == "startpos")
+                next = Position::start();
+            else if (kind == "fen" && in >> token)
+                next = Position::from_fen(token);
+            else
+            {
+                say("info string expected position startpos|fen <FEN>");
+                return;
+            }
+        }
+        catch (const exception& e)
+        {
+            say(string("info string ") + e.what());
+            return;
+        }
+        if (in >> token && token == "moves")
+        {
+            while (in >> token)
+            {
+                chain_move turn;
+                if (!parse_turn(next, token, turn))
+                {
+                    say("info string illegal move " + token + " in " + next.to_fen());
+                    return;
+                }
+                next = logic->make_turn(next, turn);
+            }
+        }
+        pos = next;
+    }
+
+    // Переопределение настройки раздела Bot; Logic пересоздаётся (размер таблицы, потоки, таблицы эндшпиля)
+    void set_option(istringstream& in)
+    {
+        string word, name, value;
+        while (in >> word)
+        {
+            if (word == "name")
+                in >> name;
+            else if (word == "value")
+                getline(in >> ws, value);
+        }
+        if (name.empty())
+        {
+            say("info string expected setoption name <key> value <value>");
+            return;
+        }
+        json parsed = json::parse(value, nullptr, false);
+        config.set("Bot", name, parsed.is_discarded() ? json(value) : parsed);
+        logic = make_unique<Logic>(nullptr, &config);
+    }
+
+    // Поиск в фоновом потоке, чтобы во время него читались команды stop и isready
+    void go(const SearchLimits& limits)
+    {
+        apply_limits(*logic, limits);
+        logic->reset_stop(); // До запуска потока: stop сразу после go остановит этот поиск
+        search = thread([this]() {
+            const auto start = chrono::steady_clock::now();
+            logic->on_iteration = [this, start](const SearchThread& th) {
+                const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                string text = "info depth " + to_string(th.completed_depth) + " score " +
+                              score_to_string(th.root_score) + " nodes " + to_string(th.stats.nodes) + " nps " +
+                              to_string(uint64_t(th.stats.nodes * 1000 / max(ms, 1e-3))) + " time " +
+                              to_string(int64_t(ms)) + " pv";
+                for (int i = 0; i < th.root_pv_length; ++i)
+                    text += " " + turn_to_string(th.root_pv[i]);
+                say(text);
+            };
+            const chain_move turn = logic->find_best_turn(pos);
+            logic->on_iteration = nullptr;
+            if (logic->from_book)
+                say("info string book move");
+            say("bestmove " + (turn.from >= 0 ? turn_to_string(turn) : string("none")));
+        });
+    }
+
+    // Остановка поиска; сигнал, пришедший без поиска, снимается следующим go
+    void stop()
+    {
+        logic->stop();
+        wait_search();
+    }
+
+    void wait_search()
+    {
+        if (search.joinable())
+            search.join();
+    }
+
+    // Анализ файла позиций: каждый поток берёт следующую позицию и ищет своим Logic в один поток
+    void batch(istringstream& in)
+    {
+        string path;
+        in >> path;
+        ifstream fin(path);
+        if (!fin)
+        {
+            say("info string can't open " + path);
+            return;
+        }
+        vector<string> fens;
+        string line;
+        while (getline(fin, line))
+        {
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (!line.empty() && line[0] != '#')
+                fens.push_back(line);
+        }
+        int workers = max(1, int(thread::hardware_concurrency()));
+        const SearchLimits limits = parse_limits(in, defaults, &workers);
+        workers = max(1, min(workers, int(fens.size())));
+
+        // Таблица на каждый поток; настройки go не меняются
+        Config batch_config = config;
+        batch_config.set("Bot", "HashMB", 16);
+        const auto start = chrono::steady_clock::now();
+        atomic<int> next{ 0 };
+        atomic<uint64_t> total_nodes{ 0 };
+        auto worker = [&]() {
+            Logic local(nullptr, &batch_config);
+            local.threads = 1; // Параллельность — на уровне позиций
+            apply_limits(local, limits);
+            while (true)
+            {
+                const int i = next++;
+                if (i >= int(fens.size()))
+                    break;
+                string text = "result " + to_string(i + 1) + " " + fens[i];
+                try
+                {
+                    const Position root = Position::from_fen(fens[i]);
+                    const auto t0 = chrono::steady_clock::now();
+                    const chain_move turn = local.find_best_turn(root);
+                    const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+                    total_nodes += local.stats.nodes;
+                    text += " bestmove " + (turn.from >= 0 ? turn_to_string(turn) : string("none")) + " score " +
+                            score_to_string(local.best_score) + " depth " + to_string(local.completed_depth) +
+                            " nodes " + to_string(local.stats.nodes) + " time " + to_string(int64_t(ms));
+                }
+                catch (const exception& e)
+                {
+                    text += string(" error ") + e.what();
+                }
+                say(text);
+            }
+        };
+        vector<thread> pool;
+        for (int i = 0; i < workers; ++i)
+            pool.emplace_back(worker);
+        for (auto& th : pool)
+            th.join();
+        const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        say("batchdone positions " + to_string(fens.size()) + " threads " + to_string(workers) + " nodes " +
+            to_string(total_nodes.load()) + " time " + to_string(int64_t(ms)));
+    }
+
+private:
+    Config config;
+    SearchLimits defaults;      // Ограничения go без параметров
+    unique_ptr<Logic> logic;    // Поиск команды go (таблица транспозиций живёт между командами)
+    Position pos = Position::start();
+    thread search;              // Поток текущего поиска go
+    mutex out_mutex;
+};
+
+int main()
+{
+    ios::sync_with_stdio(false);
+    Engine engine;
+    string line;
+    while (getline(cin, line))
+    {
+        if (!engine.command(line))
+            break;
+    }
+    return 0;
+}
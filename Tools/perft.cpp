@@ -0,0 +1,132 @@
+﻿// Perft: подсчёт листьев дерева ходов до заданной глубины — проверка корректности и скорости генератора ходов.
+// Ход — это полный ход стороны: серия взятий считается одним ходом, как в поиске бота,
+// а серии с одинаковым результатом (дамка бьёт те же фигуры в другом порядке) — одним.
+// Не использует SDL и настройки, поэтому запускается на сервере без дисплея (например, в CI).
+// Сборка (из корня проекта): g++ -std=c++17 -O2 Tools/perft.cpp -o perft
+// Запуск:
+//   ./perft [глубина]                 — набор позиций с известными значениями, сверка и скорость
+//   ./perft [глубина] --verify        — то же, но с кодом возврата 1 при расхождении (для CI)
+//   ./perft глубина --fen "W:W21,22:B1,2" [--divide] — одна позиция, --divide печатает разбивку по первым ходам
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include "../Game/MoveGen.h"
+#include "Common.h"
+
+// Число листьев на глубине depth
+uint64_t perft(Position& pos, const int depth)
+{
+    if (depth == 0)
+        return 1;
+
+    move_list turns;
+    bool beats;
+    MoveGen::find_turns(pos, turns, beats);
+    if (depth == 1)
+        return uint64_t(turns.size);
+
+    uint64_t res = 0;
+    for (const auto& turn : turns)
+    {
+        undo_info undo;
+        pos.do_move(turn, undo);
+        res += perft(pos, depth - 1);
+        pos.undo_move(turn, undo);
+    }
+    return res;
+}
+
+// Разбивка числа листьев по первым ходам
+void divide(Position pos, const int depth)
+{
+    move_list turns;
+    bool beats;
+    MoveGen::find_turns(pos, turns, beats);
+    uint64_t total = 0;
+    for (const auto& turn : turns)
+    {
+        undo_info undo;
+        pos.do_move(turn, undo);
+        const uint64_t nodes = perft(pos, depth - 1);
+        pos.undo_move(turn, undo);
+        total += nodes;
+        cout << "  " << setw(12) << turn_to_string(turn) << ": " << nodes << "\n";
+    }
+    cout << "  total: " << total << "\n";
+}
+
+struct PerftCase
+{
+    const char* name;
+    const char* fen;
+    vector<uint64_t> expected; // Ожидаемые значения для глубин 1, 2, ...
+};
+
+// Значения сверены с независимой реализацией правил на матрице доски
+const vector<PerftCase> perft_cases = {
+    { "start", "W:W21,22,23,24,25,26,27,28,29,30,31,32:B1,2,3,4,5,6,7,8,9,10,11,12",
+      { 7, 49, 302, 1469, 7482, 37986, 190146, 929978, 4571311 } },
+    { "multi-capture chain", "W:W25,K29,31,32:B3,5,7,14,15,16,22",
+      { 3, 12, 87, 372, 2846, 12140, 97769 } },
+    { "promotion mid-capture", "W:W10,27,30:B2,6,15,K25",
+      { 5, 45, 318, 2184, 15884, 109571, 795169 } },
+    { "king long jumps", "W:W26,K29,30:BK1,3,8,10,22,23",
+      { 6, 44, 215, 1400, 10070, 70639, 518607 } },
+};
+
+int main(int argc, char* argv[])
+{
+    int max_depth = 7;
+    bool verify = false, show_divide = false;
+    string fen;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--verify"))
+            verify = true;
+        else if (!strcmp(argv[i], "--divide"))
+            show_divide = true;
+        else if (!strcmp(argv[i], "--fen") && i + 1 < argc)
+            fen = argv[++i];
+        else
+            max_depth = atoi(argv[i]);
+    }
+
+    vector<PerftCase> cases = perft_cases;
+    if (!fen.empty())
+        cases = { { "custom", fen.c_str(), {} } };
+
+    bool ok = true;
+    for (const auto& test : cases)
+    {
+        Position pos = Position::from_fen(test.fen);
+        cout << test.name << " " << pos.to_fen() << "\n";
+        for (int depth = 1; depth <= max_depth; ++depth)
+        {
+            auto start = chrono::steady_clock::now();
+            const uint64_t nodes = perft(pos, depth);
+            auto end = chrono::steady_clock::now();
+            const double ms = chrono::duration<double, milli>(end - start).count();
+
+            cout << "  depth " << setw(2) << depth << setw(14) << nodes << setw(10) << fixed << setprecision(1) << ms
+                 << " ms" << setw(10) << setprecision(0) << nodes / max(ms, 1e-3) << " knps";
+            if (depth <= int(test.expected.size()))
+            {
+                const bool match = nodes == test.expected[depth - 1];
+                ok = ok && match;
+                cout << (match ? "  ok" : "  MISMATCH, expected " + to_string(test.expected[depth - 1]));
+            }
+            cout << "\n";
+        }
+        if (show_divide)
+            divide(pos, max_depth);
+    }
+
+    if (verify && !ok)
+    {
+        cout << "perft: results differ from expected values\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,295 @@
+﻿// Построение эндшпильных таблиц (выигрыш/проигрыш/ничья и число полуходов до конца партии)
+// для всех позиций с числом фигур до N. Результат читает бот (настройка Bot.TablebasePath).
+// Сборка (из корня проекта): g++ -std=c++17 -O2 -pthread Tools/tbgen.cpp -o tbgen
+// Запуск: ./tbgen [N] [--threads T] [--out tb.bin]   (по умолчанию N = 4, файл tb.bin, все ядра)
+// Размер файла: 3 фигуры — 0.2 МБ, 4 — 6 МБ, 5 — 145 МБ, 6 — 2.6 ГБ.
+//
+// Срезы (составы фигур) считаются группами {состав, перевёрнутый состав}: тихие ходы переводят позицию
+// из одного среза группы в другой, а взятия и превращения — в группы, посчитанные раньше
+// (группы идут по возрастанию числа фигур, затем числа шашек).
+// Внутри группы значения находятся итерациями до неподвижной точки: на шаге r помечаются позиции,
+// решённые ровно за r полуходов — при нечётном r выигрыш (есть ход в проигрыш соперника за r - 1 и меньше),
+// при чётном проигрыш (все ходы ведут в выигрыш соперника за r - 1 и меньше). Позиции шага
+// делятся между потоками; всё, что осталось нерешённым, — ничья
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../Game/MoveGen.h"
+#include "../Game/Tablebase.h"
+
+const int MAX_DISTANCE = 254; // Наибольшее число полуходов, помещающееся в байт
+
+// Срез в памяти генератора
+struct GenSlice
+{
+    Material material;
+    uint64_t size = 0;
+    unique_ptr<atomic<uint8_t>[]> values; // Формат байта — как в файле (см. TBHeader)
+};
+
+class Generator
+{
+public:
+    Generator(const int max_pieces, const int threads) : max_pieces(max_pieces), threads(threads)
+    {
+        for (int wm = 0; wm <= max_pieces; ++wm)
+            for (int wk = 0; wk + wm <= max_pieces; ++wk)
+                for (int bm = 0; bm + wk + wm <= max_pieces; ++bm)
+                    for (int bk = 0; bk + bm + wk + wm <= max_pieces; ++bk)
+                    {
+                        if (wm + wk == 0 || bm + bk == 0)
+                            continue;
+                        auto slice = make_unique<GenSlice>();
+                        slice->material = Material{ wm, wk, bm, bk };
+                        slice->size = TBIndex::slice_size(slice->material);
+                        slice_index[wm][wk][bm][bk] = int(slices.size());
+                        slices.push_back(move(slice));
+                    }
+    }
+
+    // Подсчёт всех групп по порядку зависимостей
+    void run()
+    {
+        vector<Material> order;
+        for (const auto& slice : slices)
+            order.push_back(slice->material);
+        stable_sort(order.begin(), order.end(), [](const Material& a, const Material& b) {
+            if (a.pieces() != b.pieces())
+                return a.pieces() < b.pieces();
+            return a.wm + a.bm < b.wm + b.bm;
+        });
+
+        for (const auto& m : order)
+        {
+            GenSlice& first = slice(m);
+            if (first.values)
+                continue; // Уже посчитан в группе с перевёрнутым составом
+            vector<GenSlice*> group = { &first };
+            if (!(m.flipped() == m))
+                group.push_back(&slice(m.flipped()));
+            solve(group);
+        }
+    }
+
+    // Запись файла таблиц
+    bool save(const string& path) const
+    {
+        FILE* fout = fopen(path.c_str(), "wb");
+        if (!fout)
+            return false;
+        TBHeader header;
+        memcpy(header.magic, TB_MAGIC, 4);
+        header.version = TB_VERSION;
+        header.max_pieces = uint32_t(max_pieces);
+        header.slice_count = uint32_t(slices.size());
+        fwrite(&header, sizeof(header), 1, fout);
+
+        uint64_t offset = sizeof(TBHeader) + slices.size() * sizeof(TBSlice);
+        for (const auto& s : slices)
+        {
+            TBSlice desc;
+            desc.wm = uint8_t(s->material.wm);
+            desc.wk = uint8_t(s->material.wk);
+            desc.bm = uint8_t(s->material.bm);
+            desc.bk = uint8_t(s->material.bk);
+            desc.reserved = 0;
+            desc.offset = offset;
+            desc.size = s->size;
+            fwrite(&desc, sizeof(desc), 1, fout);
+            offset += s->size;
+        }
+
+        vector<uint8_t> buffer;
+        for (const auto& s : slices)
+        {
+            buffer.resize(s->size);
+            for (uint64_t i = 0; i < s->size; ++i)
+                buffer[i] = s->values[i].load(memory_order_relaxed);
+            fwrite(buffer.data(), 1, buffer.size(), fout);
+        }
+        const bool ok = !ferror(fout);
+        return fclose(fout) == 0 && ok; // Запись последнего блока из буфера тоже может не удаться
+    }
+
+private:
+    GenSlice& slice(const Material& m)
+    {
+        return *slices[slice_index[m.wm][m.wk][m.bm][m.bk]];
+    }
+
+    // Значение позиции после хода (очередь соперника) — из таблиц, через переворот доски
+    uint8_t child_value(const Position& child)
+    {
+        if (!child.black)
+            return 1; // У соперника не осталось фигур — проигрыш за 0 полуходов
+        const Position norm = flip_position(child);
+        const Material m = material_of(norm);
+        return slice(m).values[TBIndex::index(norm)].load(memory_order_relaxed);
+    }
+
+    // Решение позиции на шаге round: новое значение байта или 0, если позиция ещё не решена
+    uint8_t evaluate(Position& pos, const int round)
+    {
+        move_list turns;
+        bool beats;
+        MoveGen::find_turns(pos, turns, beats);
+        const bool want_win = round % 2;
+        for (const auto& turn : turns)
+        {
+            undo_info undo;
+            pos.do_move(turn, undo);
+            const int value = child_value(pos);
+            pos.undo_move(turn, undo);
+            const int d = value - 1;
+            const bool known = value && d <= round - 1;
+            if (want_win && known && d % 2 == 0)
+                return uint8_t(round + 1); // Ход в проигрыш соперника
+            if (!want_win && !(known && d % 2 == 1))
+                return 0; // Есть ход, не ведущий в уже известный выигрыш соперника
+        }
+        return want_win ? 0 : uint8_t(round + 1);
+    }
+
+    // Итерации для группы срезов, зависящих друг от друга
+    void solve(const vector<GenSlice*>& group)
+    {
+        auto start = chrono::steady_clock::now();
+        uint64_t total = 0;
+        for (auto* s : group)
+        {
+            s->values = make_unique<atomic<uint8_t>[]>(s->size);
+            total += s->size;
+        }
+
+        int last_change = 0;
+        for (int round = 0; round <= MAX_DISTANCE; ++round)
+        {
+            atomic<uint64_t> changed{ 0 };
+            for (auto* s : group)
+            {
+                atomic<uint64_t> next_chunk{ 0 };
+                const uint64_t chunk = 4096;
+                auto worker = [&]() {
+                    uint64_t local_changed = 0;
+                    while (true)
+                    {
+                        const uint64_t begin = next_chunk.fetch_add(chunk);
+                        if (begin >= s->size)
+                            break;
+                        const uint64_t end = min(s->size, begin + chunk);
+                        for (uint64_t idx = begin; idx < end; ++idx)
+                        {
+                            if (s->values[idx].load(memory_order_relaxed))
+                                continue;
+                            Position pos;
+                            if (!TBIndex::position(s->material, idx, pos))
+                                continue;
+                            const uint8_t value = evaluate(pos, round);
+                            if (value)
+                            {
+                                // Решённые на этом шаге позиции другие потоки не учтут: их d равно round
+                                s->values[idx].store(value, memory_order_relaxed);
+                                ++local_changed;
+                            }
+                        }
+                    }
+                    changed += local_changed;
+                };
+                vector<thread> pool;
+                for (int i = 1; i < threads; ++i)
+                    pool.emplace_back(worker);
+                worker();
+                for (auto& th : pool)
+                    th.join();
+            }
+            if (changed)
+                last_change = round;
+            // Выигрыши и проигрыши из уже посчитанных групп могут появиться на любом шаге до их длины
+            if (round > max(last_change, longest) + 1)
+                break;
+        }
+        longest = max(longest, last_change);
+
+        const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        for (auto* s : group)
+            report(*s);
+        cout << "    " << total << " positions in " << fixed << setprecision(0) << ms << " ms\n";
+    }
+
+    // Итоги среза: выигрыши, проигрыши, ничьи и самый длинный выигрыш
+    void report(const GenSlice& s) const
+    {
+        uint64_t wins = 0, losses = 0, draws = 0;
+        int longest_win = 0;
+        for (uint64_t i = 0; i < s.size; ++i)
+        {
+            const int value = s.values[i].load(memory_order_relaxed);
+            if (!value)
+            {
+                ++draws; // Вместе с невозможными номерами
+                continue;
+            }
+            if ((value - 1) % 2)
+            {
+                ++wins;
+                longest_win = max(longest_win, value - 1);
+            }
+            else
+            {
+                ++losses;
+            }
+        }
+        const Material& m = s.material;
+        cout << "  W" << m.wm << "K" << m.wk << " v B" << m.bm << "K" << m.bk << ": " << wins << " wins, " << losses
+             << " losses, " << draws << " draws, longest win " << longest_win << " plies\n";
+    }
+
+private:
+    int max_pieces;
+    int threads;
+    int longest = 0; // Наибольшее число полуходов до конца партии в посчитанных группах
+    vector<unique_ptr<GenSlice>> slices;
+    int slice_index[TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1] = {};
+};
+
+int main(int argc, char* argv[])
+{
+    int max_pieces = 4;
+    int threads = max(1, int(thread::hardware_concurrency()));
+    string out = "tb.bin";
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+            threads = max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc)
+            out = argv[++i];
+        else
+            max_pieces = atoi(argv[i]);
+    }
+    if (max_pieces < 2 || max_pieces > TB_MAX_PIECES)
+    {
+        cout << "tbgen: number of pieces must be from 2 to " << TB_MAX_PIECES << "\n";
+        return 1;
+    }
+
+    cout << "Building tablebases up to " << max_pieces << " pieces, " << threads << " threads\n";
+    auto start = chrono::steady_clock::now();
+    Generator generator(max_pieces, threads);
+    generator.run();
+    if (!generator.save(out))
+    {
+        cout << "tbgen: can't write " << out << "\n";
+        return 1;
+    }
+    const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Saved " << out << " in " << fixed << setprecision(1) << sec << " s\n";
+    return 0;
+}
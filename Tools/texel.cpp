@@ -0,0 +1,427 @@
+﻿// Подбор весов оценки методом Texel по партиям бота против самого себя, в три шага:
+//   1. dump — партии без окна (по партии на ядро); из каждой сохраняются спокойные позиции (у стороны, чья
+//      очередь, нет взятий) вместе с итогом партии.
+//   2. tune — позиции переводятся в слагаемые оценки (по байту на слагаемое, 8 байт на позицию) в одном
+//      массиве; веса подбираются градиентным спуском (Adam) по среднеквадратичной ошибке предсказания итога
+//      sigmoid(K * оценка). K подбирается заранее по начальным весам, вес шашки закреплён (100) как масштаб.
+//      Градиент по массиву считается в несколько потоков.
+//   3. Веса пишутся в файл JSON; с "WeightsPath": "<файл>" в settings.json их читает Logic при запуске.
+// Сборка (из корня проекта): g++ -std=c++17 -O2 -pthread -I<путь к nlohmann/json> Tools/texel.cpp -o texel
+// Запуск из корня проекта (база настроек — settings.json, начальные веса — веса Logic по этим настройкам):
+//   ./texel dump --games 20000 --level 4 --out positions.bin [--random 8] [--threads N]
+//   ./texel tune --in positions.bin --out weights.json [--epochs 1000] [--rate 1] [--threads N]
+// Проверка результата: ./tournament --a "WeightsPath=weights.json" --b ""
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+
+#include "../Game/Logic.h"
+#include "Common.h"
+
+// Заголовок файла позиций, за ним — count записей TexelPosition
+struct TexelHeader
+{
+    char magic[4];  // "CKTP"
+    uint32_t version;
+    uint64_t count; // Число записей
+};
+
+// Спокойная позиция партии и её итог
+struct TexelPosition
+{
+    uint32_t white, black, kings;
+    uint8_t color;
+    uint8_t result; // 0 — победа чёрных, 1 — ничья, 2 — победа белых
+    uint8_t reserved[2];
+};
+
+const char TEXEL_MAGIC[4] = { 'C', 'K', 'T', 'P' };
+const uint32_t TEXEL_VERSION = 1;
+
+// Позиция в массиве настройки: слагаемые оценки с точки зрения белых и итог партии для белых (0, 1, 2)
+struct TexelSample
+{
+    int8_t features[EvalWeights::COUNT];
+    uint8_t result;
+    uint8_t reserved;
+};
+
+// Одна партия бота против самого себя; спокойные позиции после random_plies случайных полуходов
+// дописываются в out с итогом партии. Ничья — по достижении max_turns или при третьем повторении позиции,
+// как и в окне
+void play_game(Config* config, const int level, const unsigned seed, const int random_plies, const int max_turns,
+               vector<TexelPosition>& out)
+{
+    Logic logic(nullptr, config);
+    logic.Max_depth = level;
+    logic.time_limit_ms = 0; // Только глубина: итоги партий не зависят от загрузки машины
+    logic.threads = 1;       // Параллельность — на уровне партий
+    logic.seed(seed);
+
+    default_random_engine rng(seed);
+    Position pos = Position::start();
+    const size_t first = out.size();
+    RepetitionHistory repetitions;
+    bool repetition = false;
+    int turn_num = -1;
+    while (++turn_num < max_turns)
+    {
+        if (repetitions.repetitions(pos) >= 2)
+        {
+            repetition = true;
+            break;
+        }
+        move_list turns;
+        bool beats;
+        MoveGen::find_turns(pos, turns, beats);
+        if (turns.empty())
+            break; // Нет ходов — проигрыш стороны, чья очередь
+        if (turn_num < random_plies)
+        {
+            const chain_move& turn = turns.moves[rng() % turns.size];
+            repetitions.add(pos, turn);
+            pos = logic.make_turn(pos, turn);
+            continue;
+        }
+        if (!beats)
+            out.push_back(TexelPosition{ pos.white, pos.black, pos.kings, uint8_t(pos.color), 0, { 0, 0 } });
+        const chain_move turn = logic.find_best_turn(pos);
+        repetitions.add(pos, turn);
+        pos = logic.make_turn(pos, turn);
+    }
+
+    const uint8_t result = repetition || turn_num == max_turns ? 1 : pos.color ? 2 : 0;
+    for (size_t i = first; i < out.size(); ++i)
+        out[i].result = result;
+}
+
+int dump(Config& config, const int games, const int level, const int random_plies, const int workers,
+         const string& path)
+{
+    config.set("Bot", "HashMB", 16); // Таблица на каждую одновременную партию
+    config.set("Bot", "BookPath", ""); // Партии разнообразит случайное начало, а не книга
+    const int max_turns = config("Game", "MaxNumTurns");
+    cout << games << " games, level " << level << ", " << random_plies << " random plies, " << workers
+         << " parallel\n";
+
+    vector<TexelPosition> positions;
+    mutex positions_mutex;
+    atomic<int> next_game{ 0 };
+    int results[3] = { 0, 0, 0 };
+    const auto start = chrono::steady_clock::now();
+    auto worker = [&]() {
+        vector<TexelPosition> local;
+        while (true)
+        {
+            const int game = next_game++;
+            if (game >= games)
+                break;
+            local.clear();
+            play_game(&config, level, unsigned(game + 1), random_plies, max_turns, local);
+
+            lock_guard<mutex> lock(positions_mutex);
+            positions.insert(positions.end(), local.begin(), local.end());
+            if (!local.empty())
+                ++results[local[0].result];
+            if ((game + 1) % 1000 == 0)
+                cout << "  " << game + 1 << " games, " << positions.size() << " positions" << endl;
+        }
+    };
+    vector<thread> pool;
+    for (int i = 0; i < workers; ++i)
+        pool.emplace_back(worker);
+    for (auto& th : pool)
+        th.join();
+
+    ofstream fout(path, ios::binary);
+    TexelHeader header;
+    memcpy(header.magic, TEXEL_MAGIC, 4);
+    header.version = TEXEL_VERSION;
+    header.count = positions.size();
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char*>(positions.data()), streamsize(positions.size() * sizeof(TexelPosition)));
+    if (!fout)
+    {
+        cerr << "can't write " << path << "\n";
+        return 1;
+    }
+    const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << positions.size() << " positions written to " << path << " in " << fixed << setprecision(1) << sec
+         << " s (white wins " << results[2] << ", draws " << results[1] << ", black wins " << results[0] << ")\n";
+    return 0;
+}
+
+// Чтение позиций и перевод в слагаемые оценки; позиции без фигур у одной из сторон пропускаются
+bool load_samples(const string& path, vector<TexelSample>& samples)
+{
+    ifstream fin(path, ios::binary);
+    TexelHeader header;
+    if (!fin.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.magic, TEXEL_MAGIC, 4) != 0 ||
+        header.version != TEXEL_VERSION)
+        return false;
+    samples.clear();
+    samples.reserve(size_t(header.count));
+    vector<TexelPosition> block(1 << 16);
+    for (uint64_t done = 0; done < header.count;)
+    {
+        const size_t n = size_t(min<uint64_t>(block.size(), header.count - done));
+        if (!fin.read(reinterpret_cast<char*>(block.data()), streamsize(n * sizeof(TexelPosition))))
+            return false;
+        for (size_t i = 0; i < n; ++i)
+        {
+            Position pos;
+            pos.white = block[i].white;
+            pos.black = block[i].black;
+            pos.kings = block[i].kings;
+            pos.color = block[i].color;
+            if (!pos.white || !pos.black)
+                continue;
+            int features[EvalWeights::COUNT];
+            BatchEval::features(pos, features);
+            TexelSample sample;
+            for (int k = 0; k < EvalWeights::COUNT; ++k)
+                sample.features[k] = int8_t(features[k]);
+            sample.result = block[i].result;
+            sample.reserved = 0;
+            samples.push_back(sample);
+        }
+        done += n;
+    }
+    return true;
+}
+
+// Массив позиций, поделённый между потоками: каждый поток считает свою часть сумм
+class TexelSet
+{
+public:
+    TexelSet(const vector<TexelSample>& samples, const int workers) : samples(samples), workers(workers)
+    {
+    }
+
+    // Средняя ошибка предсказания итога при весах w и масштабе k (оценка в сотых долях шашки)
+    double error(const double* w, const double k) const
+    {
+        vector<double> parts(workers, 0.0);
+        run([&](const size_t begin, const size_t end, const int id) {
+            double sum = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                const double d = sigmoid(k * eval(samples[i], w)) - samples[i].result / 2.0;
+                sum += d * d;
+            }
+            parts[id] = sum;
+        });
+        double sum = 0;
+        for (const double part : parts)
+            sum += part;
+        return sum / double(max<size_t>(samples.size(), 1));
+    }
+
+    // Средняя ошибка и её градиент по весам
+    double gradient(const double* w, const double k, double* grad) const
+    {
+        vector<double> parts(workers * (EvalWeights::COUNT + 1), 0.0);
+        run([&](const size_t begin, const size_t end, const int id) {
+            double sum = 0, g[EvalWeights::COUNT] = {};
+            for (size_t i = begin; i < end; ++i)
+            {
+                const TexelSample& s = samples[i];
+                const double p = sigmoid(k * eval(s, w));
+                const double d = p - s.result / 2.0;
+                sum += d * d;
+                const double factor = d * p * (1 - p); // Производная ошибки по k * оценке, без множителя 2
+                for (int j = 0; j < EvalWeights::COUNT; ++j)
+                    g[j] += factor * s.features[j];
+            }
+            double* out = &parts[id * (EvalWeights::COUNT + 1)];
+            out[0] = sum;
+            for (int j = 0; j < EvalWeights::COUNT; ++j)
+                out[j + 1] = g[j];
+        });
+        const double n = double(max<size_t>(samples.size(), 1));
+        double sum = 0;
+        for (int j = 0; j < EvalWeights::COUNT; ++j)
+            grad[j] = 0;
+        for (int id = 0; id < workers; ++id)
+        {
+            const double* part = &parts[id * (EvalWeights::COUNT + 1)];
+            sum += part[0];
+            for (int j = 0; j < EvalWeights::COUNT; ++j)
+                grad[j] += 2 * k * part[j + 1] / n;
+        }
+        return sum / n;
+    }
+
+private:
+    static double eval(const TexelSample& s, const double* w)
+    {
+        double res = 0;
+        for (int j = 0; j < EvalWeights::COUNT; ++j)
+            res += w[j] * s.features[j];
+        return res;
+    }
+
+    // Вероятность победы белых по оценке (k уже учтён)
+    static double sigmoid(const double x)
+    {
+        return 1.0 / (1.0 + exp(-x));
+    }
+
+    template <class F> void run(F body) const
+    {
+        const size_t chunk = (samples.size() + workers - 1) / workers;
+        vector<thread> pool;
+        for (int id = 0; id < workers; ++id)
+        {
+            const size_t begin = min(samples.size(), id * chunk), end = min(samples.size(), begin + chunk);
+            pool.emplace_back(body, begin, end, id);
+        }
+        for (auto& th : pool)
+            th.join();
+    }
+
+    const vector<TexelSample>& samples;
+    int workers;
+};
+
+// Масштаб k, при котором начальные веса лучше всего предсказывают итоги (поиск золотым сечением)
+double fit_scale(const TexelSet& set, const double* w)
+{
+    double lo = 1e-4, hi = 0.1;
+    const double phi = (sqrt(5.0) - 1) / 2;
+    double a = hi - phi * (hi - lo), b = lo + phi * (hi - lo);
+    double ea = set.error(w, a), eb = set.error(w, b);
+    for (int it = 0; it < 40; ++it)
+    {
+        if (ea < eb)
+        {
+            hi = b;
+            b = a;
+            eb = ea;
+            a = hi - phi * (hi - lo);
+            ea = set.error(w, a);
+        }
+        else
+        {
+            lo = a;
+            a = b;
+            ea = eb;
+            b = lo + phi * (hi - lo);
+            eb = set.error(w, b);
+        }
+    }
+    return (lo + hi) / 2;
+}
+
+void print_weights(const double* w)
+{
+    for (int j = 0; j < EvalWeights::COUNT; ++j)
+        cout << " " << EvalWeights::name(j) << "=" << fixed << setprecision(1) << w[j];
+    cout << "\n";
+}
+
+int tune(Config& config, const string& in_path, const string& out_path, const int epochs, const double rate,
+         const int workers)
+{
+    auto start = chrono::steady_clock::now();
+    vector<TexelSample> samples;
+    if (!load_samples(in_path, samples))
+    {
+        cerr << "can't read positions from " << in_path << "\n";
+        return 1;
+    }
+    cout << samples.size() << " positions (" << samples.size() * sizeof(TexelSample) / (1 << 20) << " MB) loaded in "
+         << fixed << setprecision(1) << chrono::duration<double>(chrono::steady_clock::now() - start).count()
+         << " s\n";
+    const TexelSet set(samples, workers);
+
+    const Logic logic(nullptr, &config); // Начальные веса — по настройкам бота
+    double w[EvalWeights::COUNT];
+    for (int j = 0; j < EvalWeights::COUNT; ++j)
+        w[j] = logic.weights[j];
+    const double k = fit_scale(set, w);
+    cout << "K = " << setprecision(6) << k << ", error " << set.error(w, k) << ", initial:";
+    print_weights(w);
+
+    // Adam; вес шашки (j = 0) не меняется — он задаёт масштаб оценки
+    start = chrono::steady_clock::now();
+    double m[EvalWeights::COUNT] = {}, v[EvalWeights::COUNT] = {}, grad[EvalWeights::COUNT];
+    const double beta1 = 0.9, beta2 = 0.999, eps = 1e-12;
+    for (int epoch = 1; epoch <= epochs; ++epoch)
+    {
+        const double err = set.gradient(w, k, grad);
+        for (int j = 1; j < EvalWeights::COUNT; ++j)
+        {
+            m[j] = beta1 * m[j] + (1 - beta1) * grad[j];
+            v[j] = beta2 * v[j] + (1 - beta2) * grad[j] * grad[j];
+            const double m_hat = m[j] / (1 - pow(beta1, epoch)), v_hat = v[j] / (1 - pow(beta2, epoch));
+            w[j] -= rate * m_hat / (sqrt(v_hat) + eps);
+        }
+        if (epoch % 100 == 0 || epoch == epochs)
+        {
+            cout << "  epoch " << epoch << ": error " << setprecision(6) << err << ",";
+            print_weights(w);
+        }
+    }
+    const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << epochs << " epochs in " << setprecision(1) << sec << " s (" << setprecision(2)
+         << sec * 1000 / max(epochs, 1) << " ms per epoch, " << workers << " threads)\n";
+
+    // Веса за пределами ±MAX_WEIGHT Logic не читает
+    json out = json::object();
+    for (int j = 0; j < EvalWeights::COUNT; ++j)
+    {
+        w[j] = min(max(round(w[j]), double(-EvalWeights::MAX_WEIGHT)), double(EvalWeights::MAX_WEIGHT));
+        out[EvalWeights::name(j)] = int(w[j]);
+    }
+    ofstream fout(out_path);
+    fout << out.dump(4) << "\n";
+    if (!fout)
+    {
+        cerr << "can't write " << out_path << "\n";
+        return 1;
+    }
+    cout << "error with rounded weights " << setprecision(6) << set.error(w, k) << ", written to " << out_path
+         << ":";
+    print_weights(w);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || (strcmp(argv[1], "dump") && strcmp(argv[1], "tune")))
+    {
+        cerr << "usage: texel dump --games N --level L --out FILE | texel tune --in FILE --out FILE\n";
+        return 1;
+    }
+    Config config;
+    int games = 1000, level = 4, random_plies = 8, epochs = 1000;
+    int workers = max(1, int(thread::hardware_concurrency()));
+    double rate = 1.0;
+    string in_path = "positions.bin", out_path = strcmp(argv[1], "dump") ? "weights.json" : "positions.bin";
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "--games"))
+            games = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--level"))
+            level = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--random"))
+            random_plies = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--threads"))
+            workers = max(1, atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "--epochs"))
+            epochs = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--rate"))
+            rate = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--in"))
+            in_path = argv[i + 1];
+        else if (!strcmp(argv[i], "--out"))
+            out_path = argv[i + 1];
+    }
+    if (!strcmp(argv[1], "dump"))
+        return dump(config, games, level, random_plies, workers, out_path);
+    return tune(config, in_path, out_path, epochs, rate, workers);
+}
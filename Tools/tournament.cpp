@@ -0,0 +1,218 @@
+﻿// Турнир бот против бота без окна: тысячи партий параллельно (по партии на ядро) со сменой цветов.
+// Сравнивает две конфигурации бота A и B: победы/ничьи/поражения A, разница Эло с 95% интервалом,
+// средняя скорость поиска и среднее время на ход. Ничья — по достижении Game.MaxNumTurns или при третьем
+// повторении позиции, как и в окне.
+// Сборка (из корня проекта): g++ -std=c++17 -O2 -pthread -I<путь к nlohmann/json> Tools/tournament.cpp -o tournament
+// Запуск из корня проекта (база настроек — settings.json):
+//   ./tournament --games 1000 --a "Level=5,BotScoringType=NumberOnly" --b "Level=5,BotScoringType=NumberAndPotential"
+//   ./tournament --games 400 --a "Level=3,QuiescenceDepth=8" --b "Level=7,QuiescenceDepth=0"
+// Параметры:
+//   --games N    число партий (округляется до чётного: каждое начало играется обоими цветами)
+//   --threads N  число одновременных партий (по умолчанию — число ядер)
+//   --random N   число случайных полуходов в начале партии для разнообразия дебютов (по умолчанию 4)
+//   --a, --b     переопределения настроек раздела Bot через запятую; Level — глубина (уровень) бота.
+//                Время на ход не ограничено (BotTimeMS не действует): сравниваются только глубины и настройки
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+#include "../Game/Logic.h"
+#include "Common.h"
+
+// Настройки одного участника
+struct Engine
+{
+    string name;
+    Config config;
+    int level = 5;
+};
+
+// Итоги партий с точки зрения A
+struct TournamentStats
+{
+    int wins = 0, draws = 0, losses = 0;
+    uint64_t nodes[2] = { 0, 0 }; // По участникам A и B
+    double time_ms[2] = { 0, 0 };
+    uint64_t moves[2] = { 0, 0 };
+};
+
+// Разбор переопределений "Key=Value,Key2=Value2"
+void apply_overrides(Engine& engine, const string& overrides)
+{
+    stringstream ss(overrides);
+    string item;
+    while (getline(ss, item, ','))
+    {
+        const size_t eq = item.find('=');
+        if (eq == string::npos)
+            continue;
+        const string key = item.substr(0, eq), value = item.substr(eq + 1);
+        if (key == "Level")
+        {
+            engine.level = stoi(value);
+            continue;
+        }
+        json parsed = json::parse(value, nullptr, false);
+        engine.config.set("Bot", key, parsed.is_discarded() ? json(value) : parsed);
+    }
+}
+
+// Одна партия. a_is_white — играет ли A белыми; opening_seed задаёт случайное начало партии.
+// Возвращает 1 при победе A, 0 при ничьей, -1 при поражении A
+int play_game(Engine* engines[2], const bool a_is_white, const unsigned opening_seed, const int random_plies,
+              const int max_turns, TournamentStats& stats)
+{
+    Logic logic_a(nullptr, &engines[0]->config), logic_b(nullptr, &engines[1]->config);
+    Logic* logics[2] = { &logic_a, &logic_b };
+    for (int i = 0; i < 2; ++i)
+    {
+        logics[i]->Max_depth = engines[i]->level;
+        logics[i]->time_limit_ms = 0; // Только глубина: итог не зависит от загрузки машины
+        logics[i]->threads = 1;       // Параллельность — на уровне партий
+        logics[i]->seed(opening_seed * 2 + i);
+    }
+
+    default_random_engine rng(opening_seed);
+    Position pos = Position::start();
+    RepetitionHistory repetitions;
+    int turn_num = -1;
+    while (++turn_num < max_turns)
+    {
+        if (repetitions.repetitions(pos) >= 2)
+            return 0; // Позиция повторилась в третий раз — ничья
+        move_list turns;
+        bool beats;
+        MoveGen::find_turns(pos, turns, beats);
+        if (turns.empty())
+            break; // Нет ходов — проигрыш стороны, чья очередь
+
+        if (turn_num < random_plies)
+        {
+            // Случайное начало партии
+            const chain_move& turn = turns.moves[rng() % turns.size];
+            repetitions.add(pos, turn);
+            pos = logic_a.make_turn(pos, turn);
+            continue;
+        }
+
+        const int engine = (pos.color == 0) == a_is_white ? 0 : 1;
+        auto start = chrono::steady_clock::now();
+        const chain_move turn = logics[engine]->find_best_turn(pos);
+        auto end = chrono::steady_clock::now();
+        stats.time_ms[engine] += chrono::duration<double, milli>(end - start).count();
+        stats.nodes[engine] += logics[engine]->stats.nodes;
+        ++stats.moves[engine];
+        repetitions.add(pos, turn);
+        pos = logic_a.make_turn(pos, turn);
+    }
+
+    if (turn_num == max_turns)
+        return 0;
+    const bool a_lost = (pos.color == 0) == a_is_white;
+    return a_lost ? -1 : 1;
+}
+
+// Разница Эло по доле набранных очков
+double elo_diff(const double score)
+{
+    const double s = min(max(score, 1e-6), 1 - 1e-6);
+    return -400.0 * log10(1.0 / s - 1.0);
+}
+
+int main(int argc, char* argv[])
+{
+    int games = 200, random_plies = 4;
+    int workers = max(1, int(thread::hardware_concurrency()));
+    Engine engine_a, engine_b;
+    engine_a.name = "A";
+    engine_b.name = "B";
+    engine_a.level = engine_b.level = engine_a.config("Bot", "BlackBotLevel");
+    // По умолчанию таблица поменьше: одновременно живут две таблицы на каждую партию
+    engine_a.config.set("Bot", "HashMB", 16);
+    engine_b.config.set("Bot", "HashMB", 16);
+    string overrides[2];
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "--games"))
+            games = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--threads"))
+            workers = max(1, atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "--random"))
+            random_plies = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--a"))
+            overrides[0] = argv[i + 1];
+        else if (!strcmp(argv[i], "--b"))
+            overrides[1] = argv[i + 1];
+    }
+    apply_overrides(engine_a, overrides[0]);
+    apply_overrides(engine_b, overrides[1]);
+    games += games % 2;
+    const int max_turns = engine_a.config("Game", "MaxNumTurns");
+
+    cout << "A: level " << engine_a.level << ", " << engine_a.config("Bot", "BotScoringType") << " " << overrides[0] << "\n";
+    cout << "B: level " << engine_b.level << ", " << engine_b.config("Bot", "BotScoringType") << " " << overrides[1] << "\n";
+    cout << games << " games, " << workers << " parallel, MaxNumTurns " << max_turns << "\n";
+
+    Engine* engines[2] = { &engine_a, &engine_b };
+    TournamentStats total;
+    vector<double> results; // Очки A по партиям
+    mutex total_mutex;
+    atomic<int> next_game{ 0 };
+
+    auto worker = [&]() {
+        while (true)
+        {
+            const int game = next_game++;
+            if (game >= games)
+                break;
+            TournamentStats stats;
+            const int res = play_game(engines, game % 2 == 0, unsigned(game / 2 + 1), random_plies, max_turns, stats);
+
+            lock_guard<mutex> lock(total_mutex);
+            total.wins += res == 1;
+            total.draws += res == 0;
+            total.losses += res == -1;
+            for (int i = 0; i < 2; ++i)
+            {
+                total.nodes[i] += stats.nodes[i];
+                total.time_ms[i] += stats.time_ms[i];
+                total.moves[i] += stats.moves[i];
+            }
+            results.push_back((res + 1) / 2.0);
+            if (results.size() % 100 == 0)
+                cout << "  " << results.size() << " games: +" << total.wins << " =" << total.draws << " -"
+                     << total.losses << endl;
+        }
+    };
+    vector<thread> pool;
+    for (int i = 0; i < workers; ++i)
+        pool.emplace_back(worker);
+    for (auto& th : pool)
+        th.join();
+
+    // Доля очков A и её стандартная ошибка
+    const double n = double(results.size());
+    double mean = 0, var = 0;
+    for (const double r : results)
+        mean += r / n;
+    for (const double r : results)
+        var += (r - mean) * (r - mean) / n;
+    const double margin = 1.96 * sqrt(var / n);
+
+    cout << "\nA vs B: +" << total.wins << " =" << total.draws << " -" << total.losses << "  score "
+         << fixed << setprecision(1) << 100 * mean << "%\n";
+    cout << "Elo difference: " << setprecision(1) << elo_diff(mean) << " [" << elo_diff(mean - margin) << ", "
+         << elo_diff(mean + margin) << "] (95%)\n";
+    for (int i = 0; i < 2; ++i)
+    {
+        cout << engines[i]->name << ": " << setprecision(0) << total.nodes[i] / max(total.time_ms[i], 1e-3)
+             << " knps, " << total.nodes[i] / max<uint64_t>(total.moves[i], 1) << " nodes per move, "
+             << setprecision(2) << total.time_ms[i] / max<uint64_t>(total.moves[i], 1)
+             << " ms per move\n";
+    }
+    return 0;
+}